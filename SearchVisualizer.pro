@@ -4,32 +4,19 @@
 #
 #-------------------------------------------------
 
-QT       += core gui widgets opengl concurrent
+TEMPLATE = subdirs
 
-TARGET = SearchVisualizer
-TEMPLATE = app
+# searchcore holds the grid and the search code, and has no widget or OpenGL dependencies
+# gui is the visualizer, cli runs searches headless, bench measures the hot paths
+# scenarios runs MovingAI benchmark scenario files and checks the results for optimality
+SUBDIRS += \
+    searchcore \
+    gui \
+    cli \
+    bench \
+    scenarios
 
-CONFIG += c++11
-
-
-SOURCES += \
-    graphicswidget.cpp \
-    main.cpp \
-    mainwindow.cpp \
-    hexgrid/gridsearchevent.cpp \
-    hexgrid/hexgrid.cpp \
-    hexgrid/gridsearcher.cpp \
-    hexgrid/gridpainter.cpp
-
-HEADERS  += \
-    graphicswidget.h \
-    mainwindow.h \
-    hexgrid/gridsearchevent.h \
-    hexgrid/hexgrid.h \
-    hexgrid/gridpainter.h \
-    hexgrid/gridsearcher.h \
-    utils/channel.h \
-    algorithms/searchalgorithms.h
-
-FORMS    += \
-    mainwindow.ui
+gui.depends = searchcore
+cli.depends = searchcore
+bench.depends = searchcore
+scenarios.depends = searchcore
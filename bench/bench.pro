@@ -0,0 +1,20 @@
+QT       += core
+QT       -= gui
+
+TARGET = searchbench
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(../searchcore/searchcore.pri)
+
+win32: LIBS += -lpsapi
+
+
+SOURCES += \
+    main.cpp \
+    mapgenerator.cpp
+
+HEADERS  += \
+    mapgenerator.h
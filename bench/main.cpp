@@ -0,0 +1,538 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "hexgrid/hexgrid.h"
+#include "hexgrid/cooperativeplanner.h"
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/gridsearchevent.h"
+#include "hexgrid/pathdatabase.h"
+#include "hexgrid/wavefront.h"
+#include "utils/channel.h"
+#include "utils/spscchannel.h"
+#include "mapgenerator.h"
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+
+	struct Map
+	{
+		QString name;
+		std::unique_ptr<HexGrid> grid;
+	};
+
+	//maps are only generated right before they're benchmarked, since the big ones take hundreds of megabytes each
+	struct MapSpec
+	{
+		QString name;
+		std::function<std::unique_ptr<HexGrid>(void)> generate;
+	};
+
+	double secondsSince(Clock::time_point begin)
+	{
+		return std::chrono::duration<double>(Clock::now() - begin).count();
+	}
+
+	//peak resident memory of the whole process so far, in kilobytes, or -1 if we don't know how to get it on this platform
+	qint64 peakMemoryKilobytes(void)
+	{
+#if defined(Q_OS_WIN)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return qint64(counters.PeakWorkingSetSize / 1024);
+		return -1;
+#elif defined(Q_OS_MAC)
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return qint64(usage.ru_maxrss / 1024);
+#elif defined(Q_OS_UNIX)
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return qint64(usage.ru_maxrss);
+#else
+		return -1;
+#endif
+	}
+
+	//every result is printed as one compact json object per line, so runs from different commits can be diffed or loaded by a script
+	void report(QTextStream &out, QJsonObject result)
+	{
+		result.insert("peak_memory_kb", double(peakMemoryKilobytes()));
+		out << QJsonDocument(result).toJson(QJsonDocument::Compact) << endl;
+	}
+
+	QJsonObject mapInfo(const QString &benchmark, const Map &map)
+	{
+		QJsonObject result;
+		result.insert("benchmark", benchmark);
+		result.insert("map", map.name);
+		result.insert("width", map.grid->getWidth());
+		result.insert("height", map.grid->getHeight());
+		return result;
+	}
+
+	void benchmarkNeighbors(QTextStream &out, const Map &map, double minSeconds)
+	{
+		QList<QPoint> cells = map.grid->getCells();
+
+		//getNeighbors builds a vector of every valid neighbor
+		{
+			size_t calls = 0, total = 0;
+			auto begin = Clock::now();
+			do
+			{
+				for (const QPoint &cell : cells)
+				{
+					total += map.grid->getNeighbors(cell).size();
+				}
+				calls += cells.size();
+			} while (secondsSince(begin) < minSeconds);
+			double seconds = secondsSince(begin);
+
+			QJsonObject result = mapInfo("getNeighbors", map);
+			result.insert("calls", double(calls));
+			result.insert("ns_per_call", seconds * 1e9 / calls);
+			result.insert("checksum", double(total));
+			report(out, result);
+		}
+
+		//getPassableNeighbors is what the search engine actually uses
+		{
+			size_t calls = 0, total = 0;
+			auto begin = Clock::now();
+			do
+			{
+				for (const QPoint &cell : cells)
+				{
+					total += map.grid->getPassableNeighbors(cell);
+				}
+				calls += cells.size();
+			} while (secondsSince(begin) < minSeconds);
+			double seconds = secondsSince(begin);
+
+			QJsonObject result = mapInfo("getPassableNeighbors", map);
+			result.insert("calls", double(calls));
+			result.insert("ns_per_call", seconds * 1e9 / calls);
+			result.insert("checksum", double(total));
+			report(out, result);
+		}
+	}
+
+	void benchmarkSearch(QTextStream &out, const Map &map, GridSearcher::Engine engine, double minSeconds)
+	{
+		std::vector<QPoint> startStates, goalStates;
+		for (const QPoint &cell : map.grid->getCells())
+		{
+			GridEntry::EntryType type = map.grid->getEntry(cell).type;
+			if (type == GridEntry::Start)
+				startStates.push_back(cell);
+			else if (type == GridEntry::End)
+				goalStates.push_back(cell);
+		}
+
+		GridSearcher searcher(*map.grid, engine);
+
+		size_t iterations = 0, expansions = 0, pathLength = 0;
+		auto begin = Clock::now();
+		do
+		{
+			size_t expanded = 0;
+			std::vector<QPoint> path = searcher.findPath(startStates, goalStates, &expanded);
+
+			expansions += expanded;
+			pathLength = path.size();
+			iterations++;
+		} while (secondsSince(begin) < minSeconds);
+		double seconds = secondsSince(begin);
+
+		QJsonObject result = mapInfo("search", map);
+		result.insert("engine", engine == GridSearcher::ASTAR ? "astar" : "dijkstra");
+		result.insert("iterations", double(iterations));
+		result.insert("expansions_per_search", double(expansions / iterations));
+		result.insert("path_length", double(pathLength));
+		result.insert("ms_per_search", seconds * 1e3 / iterations);
+		result.insert("expansions_per_sec", expansions / seconds);
+		report(out, result);
+	}
+
+	//every cell's distance from the start cells, or just which cells can be reached, 64 cells at a time
+	//compare ms_per_run against a dijkstra search that expands the whole map
+	void benchmarkWavefront(QTextStream &out, const Map &map, Wavefront::Output output, int threadCount, double minSeconds)
+	{
+		std::vector<QPoint> startStates, goalStates;
+		GridSearcher::findEndpoints(*map.grid, startStates, goalStates);
+
+		Wavefront wavefront(*map.grid);
+
+		size_t iterations = 0;
+		auto begin = Clock::now();
+		do
+		{
+			wavefront.run(startStates, output, threadCount);
+			iterations++;
+		} while (secondsSince(begin) < minSeconds);
+		double seconds = secondsSince(begin);
+
+		QJsonObject result = mapInfo("wavefront", map);
+		result.insert("output", output == Wavefront::DISTANCES ? "distances" : "reachability");
+		result.insert("threads", threadCount);
+		result.insert("iterations", double(iterations));
+		result.insert("reachable_cells", double(wavefront.getReachableCount()));
+		result.insert("furthest_distance", wavefront.getFurthestDistance());
+		result.insert("ms_per_run", seconds * 1e3 / iterations);
+		result.insert("cells_per_sec", double(map.grid->getCellCount()) * iterations / seconds);
+		report(out, result);
+	}
+
+	//plans paths for the given number of agents between random open cells, with every agent keeping out of the others' way
+	//agents_per_sec is what matters. conflicts and unfinished agents should both be 0 unless the map is crowded
+	void benchmarkCooperative(QTextStream &out, const Map &map, int agentCount, double minSeconds)
+	{
+		std::vector<QPoint> openCells;
+		for (const QPoint &cell : map.grid->getCells())
+		{
+			if (map.grid->getEntry(cell).type != GridEntry::Wall)
+				openCells.push_back(cell);
+		}
+
+		//every agent needs its own start and goal
+		agentCount = qMin(agentCount, int(openCells.size() / 2));
+		std::mt19937 random(1);
+		std::shuffle(openCells.begin(), openCells.end(), random);
+
+		std::vector<CooperativePlanner::Agent> agents(agentCount);
+		for (int i = 0; i < agentCount; i++)
+		{
+			agents[i].start = openCells[i];
+			agents[i].goal = openCells[agentCount + i];
+		}
+
+		CooperativePlanner planner(*map.grid);
+		std::vector<std::vector<QPoint>> paths;
+		QString errorMessage;
+
+		size_t iterations = 0;
+		auto begin = Clock::now();
+		do
+		{
+			planner.plan(agents, paths, errorMessage);
+			iterations++;
+		} while (secondsSince(begin) < minSeconds);
+		double seconds = secondsSince(begin);
+
+		size_t totalLength = 0;
+		for (const std::vector<QPoint> &path : paths)
+		{
+			totalLength += path.size() - 1;
+		}
+
+		QJsonObject result = mapInfo("cooperative", map);
+		result.insert("agents", agentCount);
+		result.insert("iterations", double(iterations));
+		result.insert("rounds", planner.getRoundCount());
+		result.insert("mean_path_length", agentCount > 0 ? double(totalLength) / agentCount : 0.0);
+		result.insert("expansions", double(planner.getExpandedCount()));
+		result.insert("stalled_windows", double(planner.getStalledCount()));
+		result.insert("unfinished_agents", double(planner.getUnfinishedCount()));
+		result.insert("conflicts", double(CooperativePlanner::countConflicts(paths)));
+		result.insert("ms_per_plan", seconds * 1e3 / iterations);
+		result.insert("agents_per_sec", agentCount * iterations / seconds);
+		report(out, result);
+	}
+
+	//builds a path database for the map on every core, then times first move lookups and whole paths between random open cells
+	//the build is quadratic in the number of cells, so it's only run on maps up to --path-database-cells
+	void benchmarkPathDatabase(QTextStream &out, const Map &map, double minSeconds)
+	{
+		PathDatabase database;
+		QString errorMessage;
+		if (!database.build(*map.grid, 0, errorMessage))
+			return;
+
+		std::vector<QPoint> openCells;
+		for (const QPoint &cell : map.grid->getCells())
+		{
+			if (map.grid->getEntry(cell).type != GridEntry::Wall)
+				openCells.push_back(cell);
+		}
+		if (openCells.empty())
+			return;
+
+		//the same pairs are used for both measurements, so the lookups aren't timing the random number generator
+		const size_t PAIR_COUNT = 4096;
+		std::mt19937 random(1);
+		std::uniform_int_distribution<size_t> pick(0, openCells.size() - 1);
+		std::vector<std::pair<QPoint, QPoint>> pairs(PAIR_COUNT);
+		for (auto &pair : pairs)
+		{
+			pair = std::make_pair(openCells[pick(random)], openCells[pick(random)]);
+		}
+
+		size_t lookups = 0;
+		qint64 checksum = 0;
+		auto begin = Clock::now();
+		do
+		{
+			for (const auto &pair : pairs)
+			{
+				checksum += database.getFirstMove(pair.first, pair.second);
+			}
+			lookups += pairs.size();
+		} while (secondsSince(begin) < minSeconds);
+		double lookupSeconds = secondsSince(begin);
+
+		size_t paths = 0, pathCells = 0;
+		begin = Clock::now();
+		do
+		{
+			for (const auto &pair : pairs)
+			{
+				pathCells += database.findPath(pair.first, pair.second).size();
+			}
+			paths += pairs.size();
+		} while (secondsSince(begin) < minSeconds);
+		double pathSeconds = secondsSince(begin);
+
+		QJsonObject result = mapInfo("path_database", map);
+		result.insert("threads", qMax(1, int(std::thread::hardware_concurrency())));
+		result.insert("build_ms", database.getBuildMilliseconds());
+		result.insert("runs", double(database.getRunCount()));
+		result.insert("runs_per_cell", double(database.getRunCount()) / openCells.size());
+		result.insert("bytes", double(database.getMemoryUsage()));
+		result.insert("us_per_first_move", lookupSeconds * 1e6 / lookups);
+		result.insert("us_per_path", pathSeconds * 1e6 / paths);
+		result.insert("mean_path_cells", double(pathCells) / paths);
+		result.insert("checksum", double(checksum));
+		report(out, result);
+	}
+
+	QJsonArray histogramJson(const ChannelMetrics::Histogram &histogram)
+	{
+		QJsonArray result;
+		for (size_t count : histogram)
+		{
+			result.append(double(count));
+		}
+		return result;
+	}
+
+	//adds the channel's counters to a result. the histograms have one entry per power of two microseconds, see ChannelMetrics
+	void insertMetrics(QJsonObject &result, const ChannelMetrics::Snapshot &metrics)
+	{
+		result.insert("pushes", double(metrics.pushes));
+		result.insert("pops", double(metrics.pops));
+		result.insert("drops", double(metrics.drops));
+		result.insert("high_water_mark", double(metrics.highWaterMark));
+		result.insert("producer_waits", double(metrics.producerWaits));
+		result.insert("producer_wait_ms", std::chrono::duration<double, std::milli>(metrics.producerWaitTime).count());
+		result.insert("producer_wait_histogram", histogramJson(metrics.producerWaitHistogram));
+		result.insert("consumer_waits", double(metrics.consumerWaits));
+		result.insert("consumer_wait_ms", std::chrono::duration<double, std::milli>(metrics.consumerWaitTime).count());
+		result.insert("consumer_wait_histogram", histogramJson(metrics.consumerWaitHistogram));
+	}
+
+	//with a batch size of 1, items are sent with push and pop. otherwise they're sent with pushMany and popAll
+	//counting the metrics slows the channel down a little, so they're only collected when asked for
+	template<class ChannelType>
+	void benchmarkChannel(QTextStream &out, const QString &name, std::shared_ptr<ChannelType> channel, int messages, int batchSize, bool metrics)
+	{
+		if (metrics)
+		{
+			channel->enableMetrics();
+		}
+
+		auto begin = Clock::now();
+
+		//one producer thread and one consumer thread, the same as the search thread and the ui thread
+		std::thread producer([channel, messages, batchSize]()
+		{
+			std::vector<GridSearchEvent> batch;
+			for (int i = 0; i < messages; i++)
+			{
+				if (batchSize <= 1)
+				{
+					channel->push(GridSearchEvent(GridSearchEvent::EXPAND, QPoint(i, i)));
+					continue;
+				}
+
+				batch.emplace_back(GridSearchEvent::EXPAND, QPoint(i, i));
+				if (int(batch.size()) >= batchSize)
+				{
+					channel->pushMany(batch.begin(), batch.end());
+					batch.clear();
+				}
+			}
+			channel->pushMany(batch.begin(), batch.end());
+			channel->closeBack();
+		});
+
+		int received = 0;
+		if (batchSize <= 1)
+		{
+			GridSearchEvent event;
+			while (channel->pop(event))
+			{
+				received++;
+			}
+		}
+		else
+		{
+			std::vector<GridSearchEvent> events;
+			while (channel->popAll(events) > 0)
+			{
+				received += int(events.size());
+				events.clear();
+			}
+		}
+		producer.join();
+
+		double seconds = secondsSince(begin);
+
+		QJsonObject result;
+		result.insert("benchmark", "channel");
+		result.insert("channel", name);
+		result.insert("batch_size", batchSize);
+		result.insert("messages", received);
+		result.insert("messages_per_sec", received / seconds);
+		if (metrics)
+		{
+			insertMetrics(result, channel->getMetrics());
+		}
+		report(out, result);
+	}
+
+	std::vector<MapSpec> buildMapSpecs(int width, int height, const QStringList &kinds, const QList<float> &densities)
+	{
+		std::vector<MapSpec> maps;
+		for (const QString &kind : kinds)
+		{
+			if (kind == "open")
+			{
+				maps.push_back(MapSpec{ "open", [=]() { return MapGenerator::openField(width, height); } });
+			}
+			else if (kind == "random")
+			{
+				for (float density : densities)
+				{
+					maps.push_back(MapSpec{ QString("random-%1").arg(density), [=]() { return MapGenerator::randomWalls(width, height, density, 1); } });
+				}
+			}
+			else if (kind == "maze")
+			{
+				maps.push_back(MapSpec{ "maze", [=]() { return MapGenerator::maze(width, height, 1); } });
+			}
+			else if (kind == "spiral")
+			{
+				maps.push_back(MapSpec{ "spiral", [=]() { return MapGenerator::spiral(width, height); } });
+			}
+		}
+		return maps;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("searchbench");
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Benchmarks the hex grid, the search engine and the channel. Prints one json object per line.");
+	parser.addHelpOption();
+
+	QCommandLineOption sizesOption("sizes", "Comma separated list of WIDTHxHEIGHT map sizes.", "sizes", "50x40,256x256,1024x1024,4096x4096");
+	QCommandLineOption mapsOption("maps", "Comma separated list of map kinds: open, random, maze, spiral.", "maps", "open,random,maze,spiral");
+	QCommandLineOption densitiesOption("densities", "Comma separated list of wall densities for the random maps.", "densities", "0.1,0.2,0.3,0.4");
+	QCommandLineOption minTimeOption("min-time", "Minimum number of seconds to repeat each measurement for.", "seconds", "0.5");
+	QCommandLineOption agentsOption("agents", "Number of agents to plan at once in the cooperative planning benchmark.", "count", "100");
+	QCommandLineOption databaseCellsOption("path-database-cells", "Largest map, in cells, to build a path database for.", "count", "16384");
+	QCommandLineOption messagesOption("channel-messages", "Number of messages to send through each channel.", "count", "1000000");
+	parser.addOption(sizesOption);
+	parser.addOption(mapsOption);
+	parser.addOption(densitiesOption);
+	parser.addOption(minTimeOption);
+	parser.addOption(agentsOption);
+	parser.addOption(databaseCellsOption);
+	QCommandLineOption channelMetricsOption("channel-metrics", "Count pushes, pops, drops and waits in each channel benchmark, and add them to its result.");
+	parser.addOption(messagesOption);
+	parser.addOption(channelMetricsOption);
+
+	parser.process(app);
+
+	double minSeconds = parser.value(minTimeOption).toDouble();
+	int agentCount = qMax(1, parser.value(agentsOption).toInt());
+	int databaseCells = parser.value(databaseCellsOption).toInt();
+	QStringList kinds = parser.value(mapsOption).split(',', QString::SkipEmptyParts);
+
+	QList<float> densities;
+	for (const QString &density : parser.value(densitiesOption).split(',', QString::SkipEmptyParts))
+	{
+		densities.append(density.toFloat());
+	}
+
+	//channel throughput, using the same configuration as the visualizer, plus bigger and unbounded ones for comparison
+	int messages = parser.value(messagesOption).toInt();
+	bool metrics = parser.isSet(channelMetricsOption);
+	for (int batchSize : { 1, 16 })
+	{
+		benchmarkChannel(out, "block-20", std::make_shared<Channel<GridSearchEvent>>(Channel<GridSearchEvent>::BLOCK, 20), messages, batchSize, metrics);
+		benchmarkChannel(out, "block-4096", std::make_shared<Channel<GridSearchEvent>>(Channel<GridSearchEvent>::BLOCK, 4096), messages, batchSize, metrics);
+		benchmarkChannel(out, "never-full", std::make_shared<Channel<GridSearchEvent>>(), messages, batchSize, metrics);
+		benchmarkChannel(out, "spsc-block-32", std::make_shared<SpscChannel<GridSearchEvent>>(SpscChannel<GridSearchEvent>::BLOCK, 32), messages, batchSize, metrics);
+		benchmarkChannel(out, "spsc-block-4096", std::make_shared<SpscChannel<GridSearchEvent>>(SpscChannel<GridSearchEvent>::BLOCK, 4096), messages, batchSize, metrics);
+	}
+
+	for (const QString &size : parser.value(sizesOption).split(',', QString::SkipEmptyParts))
+	{
+		QStringList dimensions = size.split('x');
+		int width = dimensions.value(0).toInt();
+		int height = dimensions.value(1).toInt();
+		if (dimensions.size() != 2 || width <= 0 || height <= 0)
+		{
+			err << "Invalid size: " << size << endl;
+			return 1;
+		}
+
+		for (const MapSpec &spec : buildMapSpecs(width, height, kinds, densities))
+		{
+			Map map{ spec.name, spec.generate() };
+
+			benchmarkNeighbors(out, map, minSeconds);
+			benchmarkSearch(out, map, GridSearcher::ASTAR, minSeconds);
+			benchmarkSearch(out, map, GridSearcher::DIJKSTRA, minSeconds);
+
+			int threadCount = qMax(1, int(std::thread::hardware_concurrency()));
+			for (Wavefront::Output output : { Wavefront::DISTANCES, Wavefront::REACHABILITY })
+			{
+				benchmarkWavefront(out, map, output, 1, minSeconds);
+				benchmarkWavefront(out, map, output, threadCount, minSeconds);
+			}
+
+			benchmarkCooperative(out, map, agentCount, minSeconds);
+
+			if (map.grid->getCellCount() <= databaseCells)
+				benchmarkPathDatabase(out, map, minSeconds);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+#include "mapgenerator.h"
+
+#include <random>
+#include <vector>
+
+#include "hexgrid/hexgrid.h"
+
+std::unique_ptr<HexGrid> MapGenerator::openField(int width, int height)
+{
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height));
+
+	grid->setType(cellAt(0, 0), GridEntry::Start);
+	grid->setType(cellAt(width - 1, height - 1), GridEntry::End);
+	return grid;
+}
+
+std::unique_ptr<HexGrid> MapGenerator::randomWalls(int width, int height, float density, unsigned int seed)
+{
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height));
+
+	std::mt19937 random(seed);
+	std::bernoulli_distribution isWall(density);
+
+	for (int row = 0; row < height; row++)
+	{
+		for (int column = 0; column < width; column++)
+		{
+			if (isWall(random))
+			{
+				grid->setType(cellAt(column, row), GridEntry::Wall);
+			}
+		}
+	}
+
+	grid->setType(cellAt(0, 0), GridEntry::Start);
+	grid->setType(cellAt(width - 1, height - 1), GridEntry::End);
+	return grid;
+}
+
+std::unique_ptr<HexGrid> MapGenerator::maze(int width, int height, unsigned int seed)
+{
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height));
+
+	//start with everything walled off, then carve out the rooms and the passages between them
+	for (int row = 0; row < height; row++)
+	{
+		for (int column = 0; column < width; column++)
+		{
+			grid->setType(cellAt(column, row), GridEntry::Wall);
+		}
+	}
+
+	int roomColumns = (width + 1) / 2;
+	int roomRows = (height + 1) / 2;
+
+	std::vector<bool> visited(roomColumns * roomRows, false);
+	std::vector<std::pair<int, int>> stack;
+	std::mt19937 random(seed);
+
+	const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	stack.emplace_back(0, 0);
+	visited[0] = true;
+	grid->setType(cellAt(0, 0), GridEntry::Open);
+
+	while (!stack.empty())
+	{
+		std::pair<int, int> room = stack.back();
+
+		//collect the rooms next to this one that haven't been carved yet
+		std::vector<std::pair<int, int>> candidates;
+		for (const auto &d : directions)
+		{
+			int x = room.first + d[0];
+			int y = room.second + d[1];
+			if (x >= 0 && x < roomColumns && y >= 0 && y < roomRows && !visited[y * roomColumns + x])
+			{
+				candidates.emplace_back(x, y);
+			}
+		}
+
+		if (candidates.empty())
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		std::pair<int, int> next = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(random)];
+		visited[next.second * roomColumns + next.first] = true;
+
+		//open up the room and the wall between the two rooms
+		grid->setType(cellAt(next.first * 2, next.second * 2), GridEntry::Open);
+		grid->setType(cellAt(room.first + next.first, room.second + next.second), GridEntry::Open);
+
+		stack.push_back(next);
+	}
+
+	grid->setType(cellAt(0, 0), GridEntry::Start);
+	grid->setType(cellAt((roomColumns - 1) * 2, (roomRows - 1) * 2), GridEntry::End);
+	return grid;
+}
+
+std::unique_ptr<HexGrid> MapGenerator::spiral(int width, int height)
+{
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height));
+
+	int centerRow = height / 2;
+
+	//each ring is inset two cells from the one outside it, leaving a one cell corridor between them
+	for (int ring = 0; ; ring++)
+	{
+		int inset = ring * 2 + 1;
+		int left = inset, right = width - 1 - inset;
+		int top = inset, bottom = height - 1 - inset;
+
+		if (left >= right || top >= bottom)
+		{
+			break;
+		}
+
+		for (int column = left; column <= right; column++)
+		{
+			grid->setType(cellAt(column, top), GridEntry::Wall);
+			grid->setType(cellAt(column, bottom), GridEntry::Wall);
+		}
+		for (int row = top; row <= bottom; row++)
+		{
+			grid->setType(cellAt(left, row), GridEntry::Wall);
+			grid->setType(cellAt(right, row), GridEntry::Wall);
+		}
+
+		//alternate the opening between the left and right sides so the path has to go half way around each ring
+		int gapColumn = (ring % 2 == 0) ? left : right;
+		grid->setType(cellAt(gapColumn, centerRow), GridEntry::Open);
+	}
+
+	grid->setType(cellAt(0, 0), GridEntry::Start);
+	grid->setType(cellAt(width / 2, centerRow), GridEntry::End);
+	return grid;
+}
+
+QPoint MapGenerator::cellAt(int column, int row)
+{
+	return QPoint(column + row / 2, row);
+}
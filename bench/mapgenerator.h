@@ -0,0 +1,33 @@
+#ifndef MAPGENERATOR_H
+#define MAPGENERATOR_H
+
+#include <memory>
+
+class HexGrid;
+class QPoint;
+
+//builds synthetic maps for benchmarking. every map gets one start cell and one goal cell
+//the generators work in "storage" coordinates, where column 0 is the leftmost cell of each row of the skewed hex layout
+//in those coordinates, the cells directly left, right, above and below a cell are always its hex neighbors
+class MapGenerator
+{
+public:
+	//no walls at all, start and goal in opposite corners
+	static std::unique_ptr<HexGrid> openField(int width, int height);
+
+	//each cell is a wall with the given probability, start and goal in opposite corners
+	static std::unique_ptr<HexGrid> randomWalls(int width, int height, float density, unsigned int seed);
+
+	//a depth-first-search maze carved between the cells with even storage coordinates, start and goal in opposite corners
+	static std::unique_ptr<HexGrid> maze(int width, int height, unsigned int seed);
+
+	//concentric rings of walls with openings on alternating sides, start in a corner and goal in the center
+	static std::unique_ptr<HexGrid> spiral(int width, int height);
+
+private:
+	MapGenerator() = default;
+
+	static QPoint cellAt(int column, int row);
+};
+
+#endif // MAPGENERATOR_H
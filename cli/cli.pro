@@ -0,0 +1,14 @@
+QT       += core
+QT       -= gui
+
+TARGET = searchcli
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(../searchcore/searchcore.pri)
+
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,404 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "hexgrid/hexgrid.h"
+#include "hexgrid/gridloader.h"
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/searchservice.h"
+#include "hexgrid/searchtrace.h"
+#include "utils/channelmultiplexer.h"
+#include "utils/traceevents.h"
+
+namespace {
+	struct Query
+	{
+		std::vector<QPoint> startStates;
+		std::vector<QPoint> goalStates;
+	};
+
+	struct QueryResult
+	{
+		std::vector<QPoint> path;
+		double milliseconds;
+	};
+
+	//if the map has start and goal cells drawn on it, every query searches between them
+	//otherwise each query gets a random pair of cells that aren't walls
+	std::vector<Query> buildQueries(const HexGrid &grid, int count, unsigned int seed)
+	{
+		std::vector<QPoint> openCells, startCells, goalCells;
+		for (const QPoint &cell : grid.getCells())
+		{
+			GridEntry::EntryType type = grid.getEntry(cell).type;
+			if (type == GridEntry::Start)
+				startCells.push_back(cell);
+			else if (type == GridEntry::End)
+				goalCells.push_back(cell);
+
+			if (type != GridEntry::Wall)
+				openCells.push_back(cell);
+		}
+
+		std::vector<Query> queries(count);
+		if (!startCells.empty() && !goalCells.empty())
+		{
+			for (Query &query : queries)
+			{
+				query.startStates = startCells;
+				query.goalStates = goalCells;
+			}
+		}
+		else if (!openCells.empty())
+		{
+			std::mt19937 random(seed);
+			std::uniform_int_distribution<size_t> pick(0, openCells.size() - 1);
+
+			for (Query &query : queries)
+			{
+				query.startStates.push_back(openCells[pick(random)]);
+				query.goalStates.push_back(openCells[pick(random)]);
+			}
+		}
+		return queries;
+	}
+
+	//run the search again with progress reporting turned on, and write every event it produces to a trace file
+	bool writeTrace(QTextStream &out, const QString &fileName, const HexGrid &grid, const GridSearcher &searcher, const Query &query, QString &errorMessage)
+	{
+		SearchTraceWriter writer;
+		if (!writer.open(fileName, grid, errorMessage))
+		{
+			return false;
+		}
+
+		auto channel = std::make_shared<SpscChannel<GridSearchEvent>>();
+		std::thread searchThread([&]()
+		{
+			searcher.search(query.startStates, query.goalStates, channel);
+		});
+
+		std::vector<GridSearchEvent> events;
+		while (channel->popAll(events) > 0)
+		{
+			writer.write(events);
+			events.clear();
+		}
+		searchThread.join();
+
+		quint64 eventCount = writer.getEventCount();
+		if (!writer.close(errorMessage))
+		{
+			return false;
+		}
+
+		out << "wrote " << eventCount << " events to " << fileName << ": " << QFileInfo(fileName).size() << " bytes, "
+			<< eventCount * sizeof(GridSearchEvent) << " bytes uncompressed" << endl;
+		return true;
+	}
+
+	//run every engine at once on the same query, each on its own thread, and merge their events through one multiplexer
+	//this is the same setup the visualizer's comparison view uses, minus the drawing
+	void compareEngines(QTextStream &out, const HexGrid &grid, const Query &query)
+	{
+		struct EngineCounters
+		{
+			GridSearcher::Engine engine;
+			size_t expanded;
+			size_t backtraced;
+			double finishedMilliseconds;
+		};
+
+		std::vector<EngineCounters> counters = {
+			{ GridSearcher::ASTAR, 0, 0, -1 },
+			{ GridSearcher::DIJKSTRA, 0, 0, -1 }
+		};
+
+		auto begin = std::chrono::steady_clock::now();
+
+		ChannelMultiplexer<GridSearchEvent, SpscChannel<GridSearchEvent>> multiplexer;
+		std::vector<std::thread> threads;
+		for (const EngineCounters &engine : counters)
+		{
+			auto channel = std::make_shared<SpscChannel<GridSearchEvent>>();
+			multiplexer.add(channel);
+
+			GridSearcher::Engine e = engine.engine;
+			threads.emplace_back([&grid, &query, e, channel]()
+			{
+				GridSearcher(grid, e).search(query.startStates, query.goalStates, channel);
+			});
+		}
+
+		std::vector<GridSearchEvent> events;
+		while (!multiplexer.isFinished())
+		{
+			int index = multiplexer.select(events);
+			if (index >= 0)
+			{
+				for (const GridSearchEvent &event : events)
+				{
+					if (event.eventType == GridSearchEvent::EXPAND)
+						counters[index].expanded++;
+					else if (event.eventType == GridSearchEvent::BACKTRACE)
+						counters[index].backtraced++;
+				}
+				events.clear();
+			}
+
+			//a channel is only marked finished while the multiplexer is looking for items, so check all of them each time around
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			for (size_t i = 0; i < counters.size(); i++)
+			{
+				if (multiplexer.isFinished(i) && counters[i].finishedMilliseconds < 0)
+					counters[i].finishedMilliseconds = milliseconds;
+			}
+		}
+
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		for (const EngineCounters &engine : counters)
+		{
+			out << GridSearcher::getEngineName(engine.engine) << ": " << engine.expanded << " expanded, ";
+			if (engine.backtraced == 0)
+				out << "no path";
+			else
+				out << "length " << engine.backtraced - 1;
+			out << ", finished after " << engine.finishedMilliseconds << " ms" << endl;
+		}
+	}
+
+	//stream a trace back through a channel the same way the visualizer would, and summarize what's in it
+	bool replayTrace(QTextStream &out, const QString &fileName, QString &errorMessage)
+	{
+		SearchTraceReader reader;
+		if (!reader.open(fileName, errorMessage))
+		{
+			return false;
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+
+		auto channel = std::make_shared<SpscChannel<GridSearchEvent>>();
+		bool ok = true;
+		std::thread replayThread([&]()
+		{
+			ok = reader.replay(channel);
+		});
+
+		quint64 counts[3] = { 0, 0, 0 };
+		std::vector<GridSearchEvent> events;
+		while (channel->popAll(events) > 0)
+		{
+			for (const GridSearchEvent &event : events)
+			{
+				counts[event.eventType]++;
+			}
+			events.clear();
+		}
+		replayThread.join();
+
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		if (!ok)
+		{
+			errorMessage = QString("%1 is corrupt").arg(fileName);
+			return false;
+		}
+
+		out << fileName << ": " << reader.getWidth() << "x" << reader.getHeight() << " grid, "
+			<< reader.getEventCount() << " events in " << reader.getBlockCount() << " blocks, "
+			<< counts[GridSearchEvent::EXPAND] << " expanded, ";
+		if (counts[GridSearchEvent::NEIGHBOR] > 0)
+		{
+			out << counts[GridSearchEvent::NEIGHBOR] << " queued, ";
+		}
+		out << "path length " << qMax(quint64(1), counts[GridSearchEvent::BACKTRACE]) - 1 << endl;
+		out << "replayed in " << milliseconds << " ms";
+		if (milliseconds > 0)
+		{
+			out << " (" << reader.getEventCount() * 1000.0 / milliseconds << " events/sec)";
+		}
+		out << endl;
+		return true;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("searchcli");
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Runs searches on a hex grid map without a display, and prints the paths and timing.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("map", "Map file: a \"width height\" line, then one row per line using . # S G. With --replay, a trace file.");
+
+	QCommandLineOption queriesOption("queries", "Number of queries to run.", "count", "1");
+	QCommandLineOption engineOption("engine", "Search engine, astar or dijkstra.", "engine", "astar");
+	QCommandLineOption threadsOption("threads", "Number of threads to run the queries on.", "count", "1");
+	QCommandLineOption seedOption("seed", "Seed for the random queries used when the map has no start and goal cells.", "seed", "0");
+	QCommandLineOption quietOption("quiet", "Print only the timing, not the paths.");
+	QCommandLineOption traceOption("trace", "Record every event of the first query's search to a trace file.", "file");
+	QCommandLineOption openSetOption("open-set", "Also record each cell as it's added to the open set in the trace.");
+	QCommandLineOption sampleOption("sample", "Only record the first and then every nth expansion in the trace.", "n", "1");
+	QCommandLineOption compareOption("compare", "Also run every engine at once on the first query, and compare them.");
+	QCommandLineOption replayOption("replay", "Read a trace file instead of a map, and replay it.");
+	QCommandLineOption chromeTraceOption("chrome-trace", "Record timing spans from every thread to a chrome trace file, which chrome://tracing and perfetto can open. Needs a build with CONFIG+=tracing.", "file");
+	parser.addOption(queriesOption);
+	parser.addOption(engineOption);
+	parser.addOption(threadsOption);
+	parser.addOption(seedOption);
+	parser.addOption(quietOption);
+	parser.addOption(traceOption);
+	parser.addOption(openSetOption);
+	parser.addOption(sampleOption);
+	parser.addOption(replayOption);
+	parser.addOption(compareOption);
+	parser.addOption(chromeTraceOption);
+
+	parser.process(app);
+
+	if (parser.positionalArguments().size() != 1)
+	{
+		parser.showHelp(1);
+	}
+
+	QString errorMessage;
+	if (parser.isSet(chromeTraceOption))
+	{
+		if (!TraceEvents::enable(parser.value(chromeTraceOption), errorMessage))
+		{
+			err << errorMessage << endl;
+			return 1;
+		}
+	}
+	else
+	{
+		TraceEvents::enableFromEnvironment();
+	}
+	TRACE_THREAD_NAME("main");
+
+	if (parser.isSet(replayOption))
+	{
+		if (!replayTrace(out, parser.positionalArguments().first(), errorMessage))
+		{
+			err << errorMessage << endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	GridSearcher::Engine engine;
+	if (parser.value(engineOption) == "astar")
+		engine = GridSearcher::ASTAR;
+	else if (parser.value(engineOption) == "dijkstra")
+		engine = GridSearcher::DIJKSTRA;
+	else
+	{
+		err << "Unknown engine: " << parser.value(engineOption) << endl;
+		return 1;
+	}
+
+	int queryCount = qMax(0, parser.value(queriesOption).toInt());
+	int threadCount = qMax(1, parser.value(threadsOption).toInt());
+
+	std::unique_ptr<HexGrid> grid = GridLoader::load(parser.positionalArguments().first(), errorMessage);
+	if (grid == nullptr)
+	{
+		err << errorMessage << endl;
+		return 1;
+	}
+
+	std::vector<Query> queries = buildQueries(*grid, queryCount, parser.value(seedOption).toUInt());
+	std::vector<QueryResult> results(queries.size());
+
+	auto begin = std::chrono::steady_clock::now();
+
+	//the searches only read from the grid, so every worker can share it. each worker reuses its memory from one query to the next
+	{
+		SearchService service(threadCount);
+
+		std::vector<std::future<SearchService::Result>> futures;
+		futures.reserve(queries.size());
+		for (const Query &query : queries)
+		{
+			futures.push_back(service.submit(*grid, engine, query.startStates, query.goalStates));
+		}
+
+		for (size_t i = 0; i < futures.size(); i++)
+		{
+			SearchService::Result result = futures[i].get();
+			results[i].path = std::move(result.path);
+			results[i].milliseconds = result.milliseconds;
+		}
+	}
+
+	double totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const QueryResult &result = results[i];
+
+		out << "query " << i << ": ";
+		if (result.path.empty())
+			out << "no path";
+		else
+			out << "length " << result.path.size() - 1;
+		out << ", " << result.milliseconds << " ms";
+
+		if (!parser.isSet(quietOption))
+		{
+			for (const QPoint &p : result.path)
+			{
+				out << " (" << p.x() << "," << p.y() << ")";
+			}
+		}
+		out << endl;
+	}
+
+	out << queries.size() << " queries on " << threadCount << " threads in " << totalMilliseconds << " ms";
+	if (totalMilliseconds > 0)
+	{
+		out << " (" << queries.size() * 1000.0 / totalMilliseconds << " queries/sec)";
+	}
+	out << endl;
+
+	if (parser.isSet(compareOption) && !queries.empty())
+	{
+		compareEngines(out, *grid, queries.front());
+	}
+
+	//the trace is recorded after the timed queries, so it doesn't affect the timing
+	if (parser.isSet(traceOption) && !queries.empty())
+	{
+		GridSearcher searcher(*grid, engine, parser.isSet(openSetOption) ? GridSearcher::OPEN_SET : GridSearcher::EXPANSIONS,
+			size_t(qMax(1, parser.value(sampleOption).toInt())));
+		if (!writeTrace(out, parser.value(traceOption), *grid, searcher, queries.front(), errorMessage))
+		{
+			err << errorMessage << endl;
+			return 1;
+		}
+	}
+
+	//every worker has finished by now, so their spans can be read safely
+	if (!TraceEvents::flush(errorMessage))
+	{
+		err << errorMessage << endl;
+		return 1;
+	}
+
+	return 0;
+}
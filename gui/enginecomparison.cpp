@@ -0,0 +1,142 @@
+#include "enginecomparison.h"
+
+#include <chrono>
+
+#include <QLayout>
+#include <QWidget>
+
+#include "graphicswidget.h"
+#include "searchplayback.h"
+#include "hexgrid/hexgrid.h"
+
+namespace {
+	std::unique_ptr<HexGrid> copyGrid(const HexGrid &grid)
+	{
+		std::unique_ptr<HexGrid> copy(new HexGrid(nullptr, grid.getWidth(), grid.getHeight(), grid.getTopology()));
+		for (const QPoint &cell : grid.getCells())
+		{
+			copy->setType(cell, grid.getEntry(cell).type);
+		}
+		return copy;
+	}
+}
+
+EngineComparison::EngineComparison(SearchService &service, const HexGrid &grid, const std::vector<GridSearcher::Engine> &engines, QWidget *parent, QLayout *layout, double framesPerSecond)
+	:snapshot(copyGrid(grid))
+{
+	std::vector<QPoint> startStates, goalStates;
+	GridSearcher::findEndpoints(*snapshot, startStates, goalStates);
+
+	for (GridSearcher::Engine engine : engines)
+	{
+		std::unique_ptr<Run> run(new Run());
+		run->engine = engine;
+		run->displayGrid = copyGrid(grid);
+		run->view = new GraphicsWidget(parent);
+		run->playback = std::unique_ptr<SearchPlayback>(new SearchPlayback(*run->displayGrid, framesPerSecond));
+		run->searchMilliseconds = -1;
+		run->expanded = 0;
+		run->backtraced = 0;
+
+		layout->addWidget(run->view);
+		run->view->draw(run->displayGrid.get());
+
+		//the multiplexer has to be watching the channel before the search starts pushing into it
+		std::shared_ptr<SpscChannel<GridSearchEvent>> channel = std::make_shared<SpscChannel<GridSearchEvent>>(
+			SpscChannel<GridSearchEvent>::BLOCK, 1 << 16);
+		multiplexer.add(channel);
+		channels.push_back(channel);
+
+		//the searches only read from the snapshot, so they can all share it
+		run->result = service.submit(*snapshot, engine, startStates, goalStates, run->token, channel);
+
+		runs.push_back(std::move(run));
+	}
+}
+
+EngineComparison::~EngineComparison(void)
+{
+	//nothing else will be read, so stop the searches, and wait for them to let go of the snapshot
+	for (const std::unique_ptr<Run> &run : runs)
+	{
+		run->token.cancel();
+	}
+	for (const std::shared_ptr<SpscChannel<GridSearchEvent>> &channel : channels)
+	{
+		channel->closeFront();
+	}
+
+	for (const std::unique_ptr<Run> &run : runs)
+	{
+		if (run->result.valid())
+			run->result.wait();
+		delete run->view;
+	}
+}
+
+bool EngineComparison::update(double seconds)
+{
+	multiplexer.trySelectAll(pendingEvents);
+
+	bool running = false;
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		Run &run = *runs[i];
+
+		for (const GridSearchEvent &event : pendingEvents[i])
+		{
+			if (event.eventType == GridSearchEvent::EXPAND)
+				run.expanded++;
+			else if (event.eventType == GridSearchEvent::BACKTRACE)
+				run.backtraced++;
+		}
+
+		run.playback->append(pendingEvents[i]);
+		pendingEvents[i].clear();
+
+		run.playback->advance(seconds);
+
+		if (run.searchMilliseconds < 0 && run.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			run.searchMilliseconds = run.result.get().milliseconds;
+		}
+
+		updateDiagnostics(run);
+		run.view->draw(run.displayGrid.get());
+
+		if (!multiplexer.isFinished(i) || !(run.playback->isPaused() || run.playback->isAtEnd()))
+		{
+			running = true;
+		}
+	}
+	return running;
+}
+
+void EngineComparison::togglePaused(void)
+{
+	for (const std::unique_ptr<Run> &run : runs)
+	{
+		run->playback->setPaused(!run->playback->isPaused());
+	}
+}
+
+void EngineComparison::scaleEventsPerFrame(double factor)
+{
+	for (const std::unique_ptr<Run> &run : runs)
+	{
+		run->playback->setEventsPerFrame(qBound(1.0 / 64, run->playback->getEventsPerFrame() * factor, 1048576.0));
+	}
+}
+
+void EngineComparison::updateDiagnostics(const Run &run)
+{
+	double milliseconds = run.searchMilliseconds;
+
+	QList<QPair<QString, QString>> lines;
+	lines.append(qMakePair(QString("Engine"), GridSearcher::getEngineName(run.engine)));
+	lines.append(qMakePair(QString("Expanded"), QString::number(qulonglong(run.expanded))));
+	lines.append(qMakePair(QString("Shown"), QString("%1 / %2").arg(run.playback->getPosition()).arg(run.playback->getLength())));
+	lines.append(qMakePair(QString("Path length"), run.backtraced > 0 ? QString::number(qulonglong(run.backtraced - 1)) : QString("-")));
+	lines.append(qMakePair(QString("Search time"), milliseconds < 0 ? QString("running") : QString("%1 ms").arg(milliseconds, 0, 'f', 2)));
+	run.view->setDiagnostics(lines);
+}
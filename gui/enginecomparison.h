@@ -0,0 +1,72 @@
+#ifndef ENGINECOMPARISON_H
+#define ENGINECOMPARISON_H
+
+#include <QElapsedTimer>
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "hexgrid/gridsearchevent.h"
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/searchservice.h"
+#include "utils/channelmultiplexer.h"
+#include "utils/spscchannel.h"
+
+class QLayout;
+class QWidget;
+
+class GraphicsWidget;
+class HexGrid;
+class SearchPlayback;
+
+//runs several engines at once on the same map, each on its own search worker, and shows them side by side
+//every search reads from one shared snapshot of the grid, and draws into its own copy of it
+//the event streams are merged through a channel multiplexer, so the ui thread only has one place to look for new events
+class EngineComparison
+{
+public:
+	EngineComparison(SearchService &service, const HexGrid &grid, const std::vector<GridSearcher::Engine> &engines, QWidget *parent, QLayout *layout, double framesPerSecond);
+	~EngineComparison(void);
+
+	//pull in everything the searches have produced, advance every view by the given amount of time, and redraw
+	//returns false once every search is done and every view has shown all of its events
+	bool update(double seconds);
+
+	//the controls apply to every view at once, so they stay in step
+	void togglePaused(void);
+	void scaleEventsPerFrame(double factor);
+
+private:
+	struct Run
+	{
+		GridSearcher::Engine engine;
+
+		std::unique_ptr<HexGrid> displayGrid;
+		GraphicsWidget *view;
+		std::unique_ptr<SearchPlayback> playback;
+
+		CancellationToken token;
+		std::future<SearchService::Result> result;
+
+		//counted as events arrive, rather than as they're shown
+		size_t expanded;
+		size_t backtraced;
+
+		//how long the search took on its worker, in milliseconds, or -1 while it's still running
+		double searchMilliseconds;
+	};
+
+	void updateDiagnostics(const Run &run);
+
+	//the searches read from this until their futures are ready
+	std::unique_ptr<HexGrid> snapshot;
+
+	std::vector<std::unique_ptr<Run>> runs;
+	ChannelMultiplexer<GridSearchEvent, SpscChannel<GridSearchEvent>> multiplexer;
+	std::vector<std::shared_ptr<SpscChannel<GridSearchEvent>>> channels;
+
+	std::vector<std::vector<GridSearchEvent>> pendingEvents;
+};
+
+#endif // ENGINECOMPARISON_H
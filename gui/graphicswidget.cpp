@@ -0,0 +1,909 @@
+#include "graphicswidget.h"
+
+#include <cmath>
+
+#include <QColor>
+#include <QDebug>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QtConcurrent>
+
+
+#include "hexgrid/hexgrid.h"
+#include "utils/traceevents.h"
+
+namespace {
+	//below this many pixels between neighboring cells, cells are drawn as single pixels
+	const double LOD_CELL_PIXELS = 1.0;
+
+	//the zoom is relative to fitting the whole grid on screen
+	const double MIN_ZOOM = 0.5;
+	const double MAX_ZOOM = 4096;
+
+	const Qt::GlobalColor STYLE_COLORS[] = {
+		Qt::darkBlue,	//wall
+		Qt::yellow,		//start
+		Qt::red,		//end
+		Qt::white,		//path
+		Qt::cyan,		//searched
+		Qt::darkCyan,	//queued
+		Qt::darkGreen,	//open
+	};
+
+	//pixels that aren't over any cell
+	const QRgb BACKGROUND_COLOR = qRgb(0, 0, 0);
+
+	//every pixel is a lookup of its cell's state. there are no branches, since pixels off the grid point at a
+	//background entry past the last cell, so the compiler is free to turn this into a vector gather
+	void paletteFill(QRgb *out, const qint32 *pixelCells, int count, const quint8 *states, const QRgb *palette)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			out[i] = palette[states[pixelCells[i]]];
+		}
+	}
+
+	//the sprites only depend on the scale and skew of the transform, not where it puts the grid
+	bool sameShape(const QTransform &a, const QTransform &b)
+	{
+		return a.m11() == b.m11() && a.m12() == b.m12() && a.m21() == b.m21() && a.m22() == b.m22();
+	}
+
+	//the inverse of HexGrid::getIndex
+	QPoint cellAt(const HexGrid &grid, int index)
+	{
+		return grid.toCell(index % grid.getWidth(), index / grid.getWidth());
+	}
+
+	//calls f for every cell of the grid inside the given rect of grid coordinates, row by row
+	template<typename Function>
+	void forEachCellIn(const HexGrid &grid, const QRectF &bounds, Function f)
+	{
+		int firstRow = qMax(0, int(std::floor(bounds.top())));
+		int lastRow = qMin(grid.getHeight() - 1, int(std::ceil(bounds.bottom())));
+		int firstX = int(std::floor(bounds.left()));
+		int lastX = int(std::ceil(bounds.right()));
+
+		for (int y = firstRow; y <= lastRow; y++)
+		{
+			//see HexGrid::isValidCell for the columns each row covers
+			int leftCol = y / 2;
+			int rowEnd = qMin(leftCol + grid.getWidth() - 1, lastX);
+			for (int x = qMax(leftCol, firstX); x <= rowEnd; x++)
+			{
+				f(QPoint(x, y));
+			}
+		}
+	}
+
+	//collects the screen rects that were drawn to. a region made of thousands of rects is slower to build
+	//than it is to just copy their bounding rect, so past a point we only keep the bounding rect
+	class DirtyRegion
+	{
+	public:
+		DirtyRegion(void)
+			:count(0)
+		{}
+
+		void add(const QRect &r)
+		{
+			count++;
+			bounds |= r;
+			if (rects.size() <= MAX_RECTS)
+				rects.append(r);
+		}
+
+		int getCount(void) const
+		{
+			return count;
+		}
+
+		QRegion getRegion(void) const
+		{
+			if (rects.size() > MAX_RECTS)
+				return QRegion(bounds);
+
+			QRegion region;
+			for (const QRect &r : rects)
+			{
+				region |= r;
+			}
+			return region;
+		}
+
+	private:
+		static const int MAX_RECTS = 256;
+
+		int count;
+		QVector<QRect> rects;
+		QRect bounds;
+	};
+}
+
+const QPolygonF GraphicsWidget::DISPLAY_HEXAGON = QPolygonF({
+    QPointF( 0.333,    0.666),//top
+	QPointF(-0.333,    0.333), //top right
+	QPointF(-0.666,   -0.333), //bottom right
+    QPointF(-0.333,   -0.666),//bottom
+	QPointF( 0.333,   -0.333), //bottom left
+	QPointF( 0.666,    0.333), //top left
+    });
+
+
+
+GraphicsWidget::GraphicsWidget(QWidget *parent) :
+QWidget(parent), tileColumns(0), tileRows(0), drawnCellCount(0), grid(nullptr), viewTransform(), pixelCellsGrid(nullptr), renderMode(SpriteRender), cellStatesCurrent(false), displayControls(false)
+{
+	for (int style = 0; style < CELL_STYLE_COUNT; style++)
+	{
+		cellPalette[style] = QColor(STYLE_COLORS[style]).rgba();
+	}
+	cellPalette[CELL_STYLE_COUNT] = BACKGROUND_COLOR;
+
+	//every paint event covers its whole region, so qt doesn't need to clear it first
+	setAttribute(Qt::WA_OpaquePaintEvent);
+	resizeTiles(size());
+}
+
+void GraphicsWidget::draw(HexGrid *g)
+{
+	if (g != grid)
+	{
+		//nothing drawn for the old grid is still valid, and everything the new one has marked is about to be drawn
+		grid = g;
+		if (grid != nullptr)
+			grid->takeModifiedCells(drawCells);
+		cellStatesCurrent = false;
+		redrawAll();
+		update();
+		return;
+	}
+
+	//only the cells that changed need to be copied to the screen
+	QRegion dirty = drawModifiedCells();
+	if (!dirty.isEmpty())
+	{
+		update(dirty);
+	}
+}
+
+void GraphicsWidget::zoomAt(const QPointF &pos, double factor)
+{
+	//keep the total zoom between seeing the grid at half size and a few cells filling the screen
+	double zoom = viewTransform.m11();
+	factor = qBound(MIN_ZOOM, zoom * factor, MAX_ZOOM) / zoom;
+
+	viewTransform *= QTransform::fromTranslate(-pos.x(), -pos.y()) * QTransform::fromScale(factor, factor) * QTransform::fromTranslate(pos.x(), pos.y());
+	redrawAll();
+	update();
+}
+
+void GraphicsWidget::pan(const QPointF &offset)
+{
+	viewTransform *= QTransform::fromTranslate(offset.x(), offset.y());
+	redrawAll();
+	update();
+}
+
+void GraphicsWidget::resetView(void)
+{
+	viewTransform = QTransform();
+	redrawAll();
+	update();
+}
+
+void GraphicsWidget::setRenderMode(RenderMode mode)
+{
+	//the states aren't kept up to date while the sprites are drawn
+	renderMode = mode;
+	cellStatesCurrent = false;
+	redrawAll();
+	update();
+}
+
+GraphicsWidget::RenderMode GraphicsWidget::getRenderMode(void) const
+{
+	return renderMode;
+}
+
+int GraphicsWidget::getDrawnCellCount(void) const
+{
+	return drawnCellCount;
+}
+
+void GraphicsWidget::setControls(const QList<QPair<QString, QString>> &lines)
+{
+	int lineCount = qMax(controls.size(), lines.size());
+
+	controls = lines;
+	displayControls = !controls.isEmpty();
+	update(QRect(width() - CONTROLS_WIDTH, 0, CONTROLS_WIDTH, 5 + lineCount * 20 + 5));
+}
+
+void GraphicsWidget::setDiagnostics(const QList<QPair<QString, QString>> &lines)
+{
+	//cover both the old and the new lines, in case there are fewer of them now
+	int lineCount = qMax(diagnostics.size(), lines.size());
+
+	diagnostics = lines;
+	update(QRect(0, 0, DIAGNOSTIC_WIDTH, 5 + lineCount * 20 + 5));
+}
+
+
+
+
+void GraphicsWidget::paintEvent(QPaintEvent *event)
+{
+	TRACE_SCOPE("GraphicsWidget::paintEvent");
+
+	//only composite the parts of the grid that were damaged. the painter is clipped to the same region,
+	//so the diagnostics are only redrawn where they overlap it
+	QPainter screenPainter(this);
+	for (const QRect &damaged : event->region().rects())
+	{
+		if (renderMode == PaletteRender)
+		{
+			//the palette image is opaque and covers the whole widget
+			screenPainter.drawImage(damaged, paletteImage, damaged);
+			continue;
+		}
+
+		screenPainter.fillRect(damaged, QBrush(Qt::black));
+
+		//copy in the part of each tile the damaged rect covers
+		int firstColumn = qMax(0, damaged.left() / TILE_SIZE);
+		int lastColumn = qMin(tileColumns - 1, damaged.right() / TILE_SIZE);
+		int firstRow = qMax(0, damaged.top() / TILE_SIZE);
+		int lastRow = qMin(tileRows - 1, damaged.bottom() / TILE_SIZE);
+		for (int row = firstRow; row <= lastRow; row++)
+		{
+			for (int column = firstColumn; column <= lastColumn; column++)
+			{
+				QPoint tileOrigin(column * TILE_SIZE, row * TILE_SIZE);
+				QRect covered = damaged & QRect(tileOrigin, QSize(TILE_SIZE, TILE_SIZE));
+
+				screenPainter.drawImage(covered, tiles[row * tileColumns + column], covered.translated(-tileOrigin));
+			}
+		}
+	}
+
+	screenPainter.setPen(Qt::white);
+	for (int i = 0; i < diagnostics.size(); i++)
+	{
+		drawDiagnosticText(screenPainter, 5 + i * 20, diagnostics[i].first, diagnostics[i].second);
+	}
+
+	if (displayControls)
+	{
+		for (int i = 0; i < controls.size(); i++)
+		{
+			drawControlText(screenPainter, 5 + i * 20, controls[i].first, controls[i].second);
+		}
+	}
+}
+
+void GraphicsWidget::resizeEvent(QResizeEvent *event) {
+	resizeTiles(event->size());
+
+	//the scale of the hexagons depends on the size of the widget
+	cellSprites.clear();
+
+	//qt repaints the whole widget after a resize, so the dirty region isn't needed
+	redrawAll();
+}
+
+void GraphicsWidget::resizeTiles(const QSize &size)
+{
+	tileColumns = (size.width() + TILE_SIZE - 1) / TILE_SIZE;
+	tileRows = (size.height() + TILE_SIZE - 1) / TILE_SIZE;
+
+	tiles.clear();
+	for (int i = 0; i < tileColumns * tileRows; i++)
+	{
+		QImage tile(TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied);
+		tile.fill(Qt::transparent);
+		tiles.append(tile);
+	}
+	tileDraws = QVector<QVector<SpriteDraw>>(tiles.size());
+}
+
+void GraphicsWidget::redrawAll(void)
+{
+	TRACE_SCOPE("GraphicsWidget::redrawAll");
+
+	for (QImage &tile : tiles)
+	{
+		tile.fill(Qt::transparent);
+	}
+
+	if (grid == nullptr)
+		return;
+
+	QTransform transform = getCurrentTransform();
+	if (renderMode == PaletteRender)
+	{
+		//this is also called when nothing about the view changed, like switching render modes, so the map is only rebuilt if it's stale
+		if (!hasPixelCells(transform))
+		{
+			rebuildPixelCells(transform);
+		}
+		drawAllStates();
+		return;
+	}
+
+	if (isLevelOfDetail(transform))
+	{
+		drawAllPixels(transform);
+		return;
+	}
+
+	//draw every cell on screen. the ones off screen are drawn when they're scrolled into view, which calls this again
+	drawCells.clear();
+	forEachCellIn(*grid, getVisibleBounds(transform), [this](const QPoint &cell)
+	{
+		drawCells.append(grid->getIndex(cell));
+	});
+
+	drawSprites(transform, drawCells);
+}
+
+bool GraphicsWidget::isLevelOfDetail(const QTransform &transform)
+{
+	//once neighboring cells are less than a pixel apart, a hexagon can't be seen anyway
+	QPointF origin = transform.map(QPointF(0, 0));
+	double columnStep = QLineF(origin, transform.map(QPointF(1, 0))).length();
+	double rowStep = QLineF(origin, transform.map(QPointF(0, 1))).length();
+
+	return qMax(columnStep, rowStep) < LOD_CELL_PIXELS;
+}
+
+QRectF GraphicsWidget::getVisibleBounds(const QTransform &transform) const
+{
+	//the screen is a parallelogram in grid coordinates, so take its bounding box, with a cell of margin for the hexagon edges
+	QRectF bounds = transform.inverted().map(QPolygonF(QRectF(rect()))).boundingRect();
+	return bounds.adjusted(-1, -1, 1, 1);
+}
+
+QRegion GraphicsWidget::drawModifiedCells(void)
+{
+	TRACE_SCOPE("GraphicsWidget::drawModifiedCells");
+
+	if (grid == nullptr)
+		return QRegion();
+
+	//after a reset every cell has changed, and drawing the whole screen is cheaper than going through all of them
+	if (grid->takeModifiedCells(drawCells))
+	{
+		cellStatesCurrent = false;
+		redrawAll();
+		return QRegion(rect());
+	}
+
+	//transform coordinates to fit everything neatly on the screen
+	QTransform transform = getCurrentTransform();
+	if (renderMode == PaletteRender)
+	{
+		return drawModifiedStates(transform, drawCells);
+	}
+
+	if (isLevelOfDetail(transform))
+	{
+		return drawModifiedPixels(transform, drawCells);
+	}
+
+	return drawSprites(transform, drawCells);
+}
+
+QRegion GraphicsWidget::drawSprites(const QTransform &transform, const QVector<int> &cells)
+{
+	if (cellSprites.isEmpty() || !sameShape(transform, spriteTransform))
+	{
+		rebuildSprites(transform);
+	}
+
+	DirtyRegion dirty;
+	QRect screen = rect();
+
+	//sort each cell on screen into the tiles it overlaps. every hexagon is the same shape on screen,
+	//so drawing one is a single image copy
+	QVector<int> dirtyTiles;
+	int drawCount = 0;
+	for (int index : cells)
+	{
+		QPoint cell = cellAt(*grid, index);
+		const GridEntry &entry = grid->getEntry(cell);
+
+		QPointF center = transform.map(QPointF(cell));
+		SpriteDraw spriteDraw = { QPoint(qRound(center.x()), qRound(center.y())) - spriteCenter, getCellStyle(entry) };
+
+		QRect spriteRect(spriteDraw.topLeft, cellSprites[spriteDraw.style].size());
+		if (spriteRect.intersects(screen))
+		{
+			dirty.add(spriteRect);
+
+			int firstColumn = qMax(0, spriteRect.left() / TILE_SIZE);
+			int lastColumn = qMin(tileColumns - 1, spriteRect.right() / TILE_SIZE);
+			int firstRow = qMax(0, spriteRect.top() / TILE_SIZE);
+			int lastRow = qMin(tileRows - 1, spriteRect.bottom() / TILE_SIZE);
+			for (int row = firstRow; row <= lastRow; row++)
+			{
+				for (int column = firstColumn; column <= lastColumn; column++)
+				{
+					int tile = row * tileColumns + column;
+					if (tileDraws[tile].isEmpty())
+						dirtyTiles.append(tile);
+
+					tileDraws[tile].append(spriteDraw);
+					drawCount++;
+				}
+			}
+		}
+	}
+
+	//each tile is its own image with its own painter, so tiles can be drawn at the same time
+	//the hexagons are antialiased when the sprites are built, so copying them in doesn't need any render hints
+	//the containers are only touched through plain pointers here, so no thread ever makes them detach
+	QImage *tileImages = tiles.data();
+	QVector<SpriteDraw> *draws = tileDraws.data();
+	const QImage *sprites = cellSprites.constData();
+	int columns = tileColumns;
+
+	auto drawTile = [tileImages, draws, sprites, columns](int tile)
+	{
+		TRACE_SCOPE("GraphicsWidget draw tile");
+
+		QPainter painter(&tileImages[tile]);
+		painter.translate(-(tile % columns) * TILE_SIZE, -(tile / columns) * TILE_SIZE);
+
+		for (const SpriteDraw &spriteDraw : draws[tile])
+		{
+			painter.drawImage(spriteDraw.topLeft, sprites[spriteDraw.style]);
+		}
+		painter.end();
+
+		draws[tile].clear();
+	};
+
+	//a few cells are faster to draw here than it is to wake up the thread pool
+	if (drawCount < PARALLEL_DRAW_COUNT)
+	{
+		for (int tile : dirtyTiles)
+		{
+			drawTile(tile);
+		}
+	}
+	else
+	{
+		QtConcurrent::blockingMap(dirtyTiles, [&drawTile](int &tile) { drawTile(tile); });
+	}
+
+	drawnCellCount = dirty.getCount();
+	return dirty.getRegion();
+}
+
+QRegion GraphicsWidget::drawModifiedPixels(const QTransform &transform, const QVector<int> &cells)
+{
+	DirtyRegion dirty;
+	QRect screen = rect();
+
+	//every cell is smaller than a pixel, so each modified one is written straight into the pixel under its center
+	//the center is floored rather than truncated, so cells just left of or above the screen don't land on its edge
+	for (int index : cells)
+	{
+		QPoint cell = cellAt(*grid, index);
+		QPointF center = transform.map(QPointF(cell));
+		QPoint pixel(int(std::floor(center.x())), int(std::floor(center.y())));
+		if (screen.contains(pixel))
+		{
+			QImage &tile = tiles[(pixel.y() / TILE_SIZE) * tileColumns + pixel.x() / TILE_SIZE];
+			QRgb *line = reinterpret_cast<QRgb*>(tile.scanLine(pixel.y() % TILE_SIZE));
+			line[pixel.x() % TILE_SIZE] = QColor(STYLE_COLORS[getCellStyle(grid->getEntry(cell))]).rgba();
+
+			dirty.add(QRect(pixel, QSize(1, 1)));
+		}
+	}
+
+	drawnCellCount = dirty.getCount();
+	return dirty.getRegion();
+}
+
+void GraphicsWidget::rebuildPixelCells(const QTransform &transform)
+{
+	TRACE_SCOPE("GraphicsWidget::rebuildPixelCells");
+
+	int pixelWidth = width();
+	int pixelHeight = height();
+	int cellCount = grid->getCellCount();
+
+	pixelCells.resize(pixelWidth * pixelHeight);
+
+	//every row of pixels only writes its own part of the map, so the rows are filled in parallel
+	QVector<int> rows;
+	for (int y = 0; y < pixelHeight; y++)
+	{
+		rows.append(y);
+	}
+
+	QTransform inverse = transform.inverted();
+	qint32 *cells = pixelCells.data();
+	const HexGrid *pickedGrid = grid;
+
+	QtConcurrent::blockingMap(rows, [&](int &y)
+	{
+		qint32 *line = cells + y * pixelWidth;
+		for (int x = 0; x < pixelWidth; x++)
+		{
+			QPoint cell = pickCell(inverse, QPointF(x + 0.5, y + 0.5));
+			line[x] = pickedGrid->isValidCell(cell) ? pickedGrid->getIndex(cell) : cellCount;
+		}
+	});
+
+	pixelCellsSize = QSize(pixelWidth, pixelHeight);
+	pixelCellsTransform = transform;
+	pixelCellsGrid = grid;
+}
+
+bool GraphicsWidget::hasPixelCells(const QTransform &transform) const
+{
+	return grid != nullptr && grid == pixelCellsGrid && size() == pixelCellsSize && transform == pixelCellsTransform;
+}
+
+QRegion GraphicsWidget::drawModifiedStates(const QTransform &transform, const QVector<int> &cells)
+{
+	if (cellSprites.isEmpty() || !sameShape(transform, spriteTransform))
+	{
+		rebuildSprites(transform);
+	}
+
+	//a changed cell is one byte written into the state array. the pixels it covers are found again by the palette pass
+	//the sprites are the same size as a cell on screen, so they give the rect to refresh
+	DirtyRegion dirty;
+	QRect screen = rect();
+	quint8 *states = cellStates.data();
+	for (int index : cells)
+	{
+		QPoint cell = cellAt(*grid, index);
+		states[index] = quint8(getCellStyle(grid->getEntry(cell)));
+
+		QPointF center = transform.map(QPointF(cell));
+		QRect cellRect(QPoint(qRound(center.x()), qRound(center.y())) - spriteCenter, cellSprites[0].size());
+		if (cellRect.intersects(screen))
+		{
+			dirty.add(cellRect);
+		}
+	}
+
+	drawnCellCount = dirty.getCount();
+
+	QRegion region = dirty.getRegion() & QRegion(QRect(QPoint(0, 0), pixelCellsSize));
+	for (const QRect &r : region.rects())
+	{
+		for (int y = r.top(); y <= r.bottom(); y++)
+		{
+			QRgb *line = reinterpret_cast<QRgb*>(paletteImage.scanLine(y));
+			paletteFill(line + r.left(), pixelCells.constData() + y * pixelCellsSize.width() + r.left(), r.width(), states, cellPalette);
+		}
+	}
+	return region;
+}
+
+void GraphicsWidget::drawAllStates(void)
+{
+	TRACE_SCOPE("GraphicsWidget::drawAllStates");
+
+	//every cell's state is filled in once when the palette render starts, then drawModifiedStates keeps them up to date,
+	//so moving the view only has to recolor the pixels
+	if (!cellStatesCurrent)
+	{
+		int cellCount = grid->getCellCount();
+		cellStates.resize(cellCount + 1);
+		for (int index = 0; index < cellCount; index++)
+		{
+			cellStates[index] = quint8(getCellStyle(grid->getEntry(cellAt(*grid, index))));
+		}
+		cellStates[cellCount] = CELL_STYLE_COUNT;
+		cellStatesCurrent = true;
+	}
+	quint8 *states = cellStates.data();
+
+	if (paletteImage.size() != pixelCellsSize)
+	{
+		paletteImage = QImage(pixelCellsSize, QImage::Format_ARGB32_Premultiplied);
+	}
+
+	//one gather pass over the whole screen, split into bands of rows
+	const int bandHeight = 64;
+	QVector<int> bands;
+	for (int y = 0; y < pixelCellsSize.height(); y += bandHeight)
+	{
+		bands.append(y);
+	}
+
+	QImage *image = &paletteImage;
+	const qint32 *cells = pixelCells.constData();
+	const QRgb *colors = cellPalette;
+	int pixelWidth = pixelCellsSize.width();
+	int pixelHeight = pixelCellsSize.height();
+
+	QtConcurrent::blockingMap(bands, [&](int &top)
+	{
+		for (int y = top; y < qMin(top + bandHeight, pixelHeight); y++)
+		{
+			paletteFill(reinterpret_cast<QRgb*>(image->scanLine(y)), cells + y * pixelWidth, pixelWidth, states, colors);
+		}
+	});
+
+	drawnCellCount = pixelWidth * pixelHeight;
+}
+
+void GraphicsWidget::drawAllPixels(const QTransform &transform)
+{
+	TRACE_SCOPE("GraphicsWidget::drawAllPixels");
+
+	QRgb styleColors[CELL_STYLE_COUNT];
+	for (int style = 0; style < CELL_STYLE_COUNT; style++)
+	{
+		styleColors[style] = QColor(STYLE_COLORS[style]).rgba();
+	}
+
+	//sample the cell at the center of every pixel on screen, so the cost depends on the size of the screen instead of the grid
+	//every tile writes only its own scanlines, so they're filled in parallel
+	QVector<int> tileIndexes;
+	for (int tile = 0; tile < tiles.size(); tile++)
+	{
+		tileIndexes.append(tile);
+	}
+
+	drawnCellCount = tiles.size() * TILE_SIZE * TILE_SIZE;
+
+	QTransform inverse = transform.inverted();
+	QImage *tileImages = tiles.data();
+	const HexGrid *sampledGrid = grid;
+	int columns = tileColumns;
+
+	QtConcurrent::blockingMap(tileIndexes, [&](int &tile)
+	{
+		QPoint tileOrigin((tile % columns) * TILE_SIZE, (tile / columns) * TILE_SIZE);
+		QImage &image = tileImages[tile];
+
+		for (int y = 0; y < TILE_SIZE; y++)
+		{
+			QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+			for (int x = 0; x < TILE_SIZE; x++)
+			{
+				QPointF local = inverse.map(QPointF(tileOrigin.x() + x + 0.5, tileOrigin.y() + y + 0.5));
+				QPoint cell(qRound(local.x()), qRound(local.y()));
+
+				if (sampledGrid->isValidCell(cell))
+					line[x] = styleColors[getCellStyle(sampledGrid->getEntry(cell))];
+			}
+		}
+	});
+}
+
+GraphicsWidget::CellStyle GraphicsWidget::getCellStyle(const GridEntry &entry)
+{
+	if (entry.type == GridEntry::Wall)
+		return WallStyle;
+	else if (entry.type == GridEntry::Start)
+		return StartStyle;
+	else if (entry.type == GridEntry::End)
+		return EndStyle;
+	else if (entry.path)
+		return PathStyle;
+	else if (entry.searched)
+		return SearchedStyle;
+	else if (entry.queued)
+		return QueuedStyle;
+	else
+		return OpenStyle;
+}
+
+void GraphicsWidget::rebuildSprites(const QTransform &transform)
+{
+	//drop the translation, so the hexagon is centered on the origin, then leave a pixel of room for the antialiased edges
+	QTransform shape(transform.m11(), transform.m12(), transform.m21(), transform.m22(), 0, 0);
+	QRectF bounds = shape.map(DISPLAY_HEXAGON).boundingRect();
+
+	spriteCenter = QPoint(int(std::ceil(-bounds.left())) + 1, int(std::ceil(-bounds.top())) + 1);
+	QSize spriteSize(spriteCenter.x() + int(std::ceil(bounds.right())) + 1, spriteCenter.y() + int(std::ceil(bounds.bottom())) + 1);
+
+	cellSprites.clear();
+	for (int style = 0; style < CELL_STYLE_COUNT; style++)
+	{
+		QImage sprite(spriteSize, QImage::Format_ARGB32_Premultiplied);
+		sprite.fill(Qt::transparent);
+
+		QPainter painter(&sprite);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setRenderHint(QPainter::HighQualityAntialiasing);
+		painter.setWorldTransform(shape * QTransform::fromTranslate(spriteCenter.x(), spriteCenter.y()));
+
+		QPen pen(Qt::black);
+		pen.setWidthF(0);
+
+		painter.setPen(pen);
+		painter.setBrush(STYLE_COLORS[style]);
+		painter.drawConvexPolygon(DISPLAY_HEXAGON);
+		painter.end();
+
+		cellSprites.append(sprite);
+	}
+
+	spriteTransform = transform;
+}
+
+QPoint GraphicsWidget::pickCell(const QPointF &pos)
+{
+	if (grid == nullptr || pos.x() < 0 || pos.y() < 0 || pos.x() >= width() || pos.y() >= height())
+	{
+		return QPoint(-1, -1);
+	}
+
+	//a stroke picks on every mouse move, so the map is built once and every pick after that is one lookup
+	QTransform transform = getCurrentTransform();
+	if (!hasPixelCells(transform))
+	{
+		rebuildPixelCells(transform);
+	}
+
+	qint32 index = pixelCells[int(pos.y()) * pixelCellsSize.width() + int(pos.x())];
+	if (index >= grid->getCellCount())
+		return QPoint(-1, -1);
+
+	return cellAt(*grid, index);
+}
+
+QPoint GraphicsWidget::pickCell(const QTransform &inverse, const QPointF &pos)
+{
+    //transform the weird skewed coordinates back to
+	QPointF localPos = inverse.map(pos);
+
+	int roundedX = qRound(localPos.x());
+	int roundedY = qRound(localPos.y());
+
+    //subtract the square grid cell we're on from the floating point location
+	float compX = localPos.x() - roundedX;
+	float compY = localPos.y() - roundedY;
+
+    //if the point is inside the hexagon then we know it would have been inside the hexagon when it was unskewed
+    if (sign(compX) == sign(compY) || DISPLAY_HEXAGON.containsPoint(QPointF(compX, compY), Qt::OddEvenFill))
+	{
+		return QPoint(roundedX, roundedY);
+	}
+	else
+	{
+		//we can tell if the correct hexagon is above, below, left, or right purely by comparing compX and compY
+		//if compX + compY is greater than zero, we know it must be y+1 or x+1
+		if (compX + compY > 0) {
+
+			//if compY is greater than compX, it is y+1
+			if (compY > compX)
+				return QPoint(roundedX, roundedY + 1);
+			else
+				return QPoint(roundedX + 1, roundedY);
+		}
+		else
+		{
+			//it must be y-1 or x-1
+
+			//if compY is less than compX, it must be y-1
+			if (compY < compX)
+				return QPoint(roundedX, roundedY - 1);
+			else
+				return QPoint(roundedX - 1, roundedY);
+		}
+	}
+}
+
+
+
+QTransform GraphicsWidget::getCurrentTransform(void) const
+{
+	QTransform t;
+
+	if (grid != nullptr)
+	{
+		//each hexagon is composed of 6 equilateral triangles. we don't explicitly draw the triangles
+		//but it helps to know the side length of those triangles
+		//this comes from the pythagorean theorem. if the height of an equilateral triangle is h, then
+		//the side length is 2*h / sqrt(h). in this case h is 0.5, so the side length is 1 / sqrt(3)
+		float triangleSide = 1 / sqrt(3);
+		float lineHeight = triangleSide * 1.5;
+		float lineWidth = 1;
+
+		//the columnhs shift left/right every other row,
+		//so the "actual" width is one half wider than the stated width
+		float gridWidth = (grid->getWidth() + 0.5) * lineWidth;
+
+		//the cells are regular hexagons, so the tips point above/below the actual row
+		//0.5 of a unit above, and 0.5 of a unit below
+		float gridHeight = (grid->getHeight() + 1) * lineHeight;
+
+		float screenFill = 0.98;
+		float screenWidth = width() * screenFill;
+		float screenHeight = height() * screenFill;
+
+		//find the ratio from screen width to grid width, and screen height to grid height
+		float widthRatio = screenWidth / gridWidth;
+		float heightRatio = screenHeight / gridHeight;
+
+		float scale = qMin(widthRatio, heightRatio);
+
+
+
+		//vertically and horizontally center the resulting data
+		float resultHeight = gridHeight * scale;
+		float resultWidth = gridWidth * scale;
+
+		float translateX = (width() - resultWidth) / 2 + lineWidth*scale * 2;
+		float translateY = (height() - resultHeight) / 2 + lineHeight*scale;
+
+		//apply the transformations to the matrix
+		t.shear(-triangleSide, 0);
+		t.translate(translateX, translateY);
+		t.scale(scale, scale * lineHeight);
+	}
+
+	//zoom and pan on top of fitting the grid to the screen
+	return t * viewTransform;
+}
+
+
+void GraphicsWidget::drawDiagnosticText(QPainter &painter, int top,
+	const QString &labelText, const QString &valueText)
+{
+	int labelLeft = 5;
+	int labelWidth = 140;
+	int valueLeft = labelLeft + labelWidth + 5;
+	int valueWidth = 100;
+
+	if (!staticText.contains(labelText))
+	{
+		QStaticText t(labelText);
+		t.setPerformanceHint(QStaticText::AggressiveCaching);
+		t.setTextFormat(Qt::PlainText);
+		t.setTextWidth(labelWidth);
+		t.setTextOption(QTextOption(Qt::AlignRight));
+
+		staticText.insert(labelText, t);
+	}
+
+	painter.drawStaticText(labelLeft, top, staticText.value(labelText));
+	painter.drawText(QRect(valueLeft, top, valueWidth, 20), valueText, QTextOption(Qt::AlignRight));
+}
+
+void GraphicsWidget::drawControlText(QPainter &painter, int top,
+	const QString &labelText, const QString &valueText)
+{
+	int labelLeft = width() - 200 + 5;
+	int labelWidth = 40;
+	int valueLeft = labelLeft + labelWidth + 10;
+	int valueWidth = 150;
+
+	if (!staticText.contains(labelText))
+	{
+		QStaticText t(labelText);
+		t.setPerformanceHint(QStaticText::AggressiveCaching);
+		t.setTextFormat(Qt::PlainText);
+		t.setTextWidth(labelWidth);
+		t.setTextOption(QTextOption(Qt::AlignRight));
+
+		staticText.insert(labelText, t);
+	}
+
+	if (!staticText.contains(valueText))
+	{
+		QStaticText t(valueText);
+		t.setPerformanceHint(QStaticText::AggressiveCaching);
+		t.setTextFormat(Qt::PlainText);
+		t.setTextWidth(valueWidth);
+		t.setTextOption(QTextOption(Qt::AlignLeft));
+
+		staticText.insert(valueText, t);
+	}
+
+	painter.drawStaticText(labelLeft, top, staticText.value(labelText));
+	painter.drawStaticText(valueLeft, top, staticText.value(valueText));
+}
@@ -0,0 +1,165 @@
+#ifndef GRAPHICSWIDGET_H
+#define GRAPHICSWIDGET_H
+
+#include <memory>
+#include <QWidget>
+#include <QStaticText>
+#include <QImage>
+#include <QRegion>
+#include <QVector>
+
+class HexGrid;
+class GridEntry;
+
+class GraphicsWidget : public QWidget
+{
+	Q_OBJECT
+public:
+	explicit GraphicsWidget(QWidget *parent = 0);
+
+	//draws the cells of the grid that were modified since the last call, and repaints only the part of the screen they cover
+	void draw(HexGrid *grid);
+
+	//looks the cell up in the map of the cell under each pixel, which is built on the first pick after the view changes
+	QPoint pickCell(const QPointF &pos);
+
+	//zooms the view by the given factor, keeping whatever is under pos in place
+	void zoomAt(const QPointF &pos, double factor);
+
+	//moves the view by the given number of pixels
+	void pan(const QPointF &offset);
+
+	//goes back to fitting the whole grid on screen
+	void resetView(void);
+
+	//sprites draw every cell as an antialiased hexagon. the palette mode looks up the cell under each pixel
+	//in a map that's built when the view changes, and colors the pixel by that cell's state
+	enum RenderMode { SpriteRender, PaletteRender };
+	void setRenderMode(RenderMode mode);
+	RenderMode getRenderMode(void) const;
+
+	//label/value pairs drawn in the top left corner, on top of the grid
+	void setDiagnostics(const QList<QPair<QString, QString>> &lines);
+
+	//key/description pairs drawn in the top right corner, on top of the grid
+	void setControls(const QList<QPair<QString, QString>> &lines);
+
+	//the number of cells drawn by the last call to draw, or pixels sampled when every cell is smaller than a pixel
+	int getDrawnCellCount(void) const;
+
+protected:
+	void paintEvent(QPaintEvent *event);
+	void resizeEvent(QResizeEvent *event);
+
+	void drawDiagnosticText(QPainter &painter, int top,
+		const QString &labelText, const QString &valueText);
+	void drawControlText(QPainter &painter, int top,
+		const QString &labelText, const QString &valueText);
+
+	QTransform getCurrentTransform(void) const;
+
+private:
+	//the states a cell can be drawn in, one sprite each
+	enum CellStyle { WallStyle, StartStyle, EndStyle, PathStyle, SearchedStyle, QueuedStyle, OpenStyle, CELL_STYLE_COUNT };
+	static CellStyle getCellStyle(const GridEntry &entry);
+
+	//pre-renders one hexagon per cell style at the scale and skew of the given transform
+	void rebuildSprites(const QTransform &transform);
+
+	//draws every cell modified since the last call into the tiles, and returns the screen region they cover
+	//only the grid's list of modified cells is looked at, so the cost doesn't depend on the size of the grid
+	QRegion drawModifiedCells(void);
+
+	//draws the cells with the given indexes as hexagons. cells off screen are skipped
+	QRegion drawSprites(const QTransform &transform, const QVector<int> &cells);
+
+	//when cells are smaller than a pixel, they're written as single pixels instead of drawn as hexagons
+	static bool isLevelOfDetail(const QTransform &transform);
+	QRegion drawModifiedPixels(const QTransform &transform, const QVector<int> &cells);
+	void drawAllPixels(const QTransform &transform);
+
+	//the rect of grid coordinates that covers the screen
+	QRectF getVisibleBounds(const QTransform &transform) const;
+
+	//finds the cell under the given point by working backwards through the transform
+	static QPoint pickCell(const QTransform &inverse, const QPointF &pos);
+
+	//works out the cell under every pixel on screen, for picking and the palette render
+	void rebuildPixelCells(const QTransform &transform);
+
+	//true if pixelCells was built for the current grid and size and the given transform
+	bool hasPixelCells(const QTransform &transform) const;
+
+	//the palette render: modified cells only update their state, then the pixels are recolored from the states
+	QRegion drawModifiedStates(const QTransform &transform, const QVector<int> &cells);
+	void drawAllStates(void);
+
+	//clears the tiles and draws every cell again
+	void redrawAll(void);
+
+	//replaces the tiles with empty ones that cover the given size
+	void resizeTiles(const QSize &size);
+
+	//the width of the areas the diagnostics and controls are drawn in, see drawDiagnosticText and drawControlText
+	static const int DIAGNOSTIC_WIDTH = 255;
+	static const int CONTROLS_WIDTH = 200;
+
+	QMap<QString, QStaticText> staticText;
+
+	//the grid is drawn into square tiles, which are drawn in parallel when there are enough cells to draw
+	static const int TILE_SIZE = 256;
+	static const int PARALLEL_DRAW_COUNT = 2048;
+
+	struct SpriteDraw
+	{
+		QPoint topLeft;
+		CellStyle style;
+	};
+
+	QVector<QImage> tiles;
+	int tileColumns, tileRows;
+
+	//the sprites waiting to be drawn into each tile. kept between calls so they don't have to be reallocated
+	QVector<QVector<SpriteDraw>> tileDraws;
+	int drawnCellCount;
+
+	//the indexes of the cells being drawn, taken from the grid's modified list or collected by redrawAll
+	//kept between calls so it doesn't have to be reallocated
+	QVector<int> drawCells;
+
+	//the sprites are drawn with the center of the cell at spriteCenter, and are only valid for spriteTransform
+	QVector<QImage> cellSprites;
+	QPoint spriteCenter;
+	QTransform spriteTransform;
+
+	HexGrid *grid;
+
+	//applied after the transform that fits the grid on screen
+	QTransform viewTransform;
+
+	//the index of the cell under each pixel, row by row. pixels off the grid hold the cell count
+	//it's only rebuilt when it's needed after the size or transform changed, so panning and zooming don't pay for it
+	//the palette render rebuilds it when it's drawn, and picking rebuilds it on the first pick
+	QVector<qint32> pixelCells;
+	QSize pixelCellsSize;
+	QTransform pixelCellsTransform;
+	const HexGrid *pixelCellsGrid;
+
+	//the style of each cell, plus a background entry for the pixels off the grid
+	//it's filled in when the palette render starts, and kept up to date from the modified cells while it's on
+	RenderMode renderMode;
+	QVector<quint8> cellStates;
+	bool cellStatesCurrent;
+	QRgb cellPalette[CELL_STYLE_COUNT + 1];
+	QImage paletteImage;
+
+	QList<QPair<QString, QString>> diagnostics;
+	QList<QPair<QString, QString>> controls;
+
+	bool displayControls;
+
+    const static QPolygonF DISPLAY_HEXAGON;
+
+};
+
+#endif // GRAPHICSWIDGET_H
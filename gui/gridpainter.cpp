@@ -0,0 +1,186 @@
+#include "gridpainter.h"
+
+#include <atomic>
+#include <memory>
+
+#include <QtConcurrent>
+
+namespace {
+	//below this many cells, a wavefront is expanded on this thread rather than split across the pool
+	const size_t PARALLEL_FRONTIER_SIZE = 4096;
+	const size_t FRONTIER_CHUNK_SIZE = 1024;
+
+	const int MAX_BRUSH_RADIUS = 64;
+}
+
+GridPainter::GridPainter(HexGrid &grid) :
+	grid(grid), paintMode(GridEntry::Open), brushRadius(0), hasLastCell(false), filling(false)
+{
+}
+
+bool GridPainter::start(const QPoint &cursorPos)
+{
+	if (grid.isValidCell(cursorPos))
+	{
+		const GridEntry& currentEntry = grid.getEntry(cursorPos);
+
+		//begin drawing. the color we paint during this drawing session depends on the color
+		//of the cell under the cursor. if it is the same as the color the user is trying to draw
+		//switch to "erase mode" instead
+		GridEntry::EntryType type = currentEntry.type;
+		if (pressedKeys.contains(Qt::Key_S) && type != GridEntry::Start)
+			paintMode = GridEntry::Start;
+
+        else if (pressedKeys.contains(Qt::Key_G) && type != GridEntry::End)
+			paintMode = GridEntry::End;
+
+		else if (pressedKeys.contains(Qt::Key_W) && type != GridEntry::Wall)
+			paintMode = GridEntry::Wall;
+
+		else
+			paintMode = GridEntry::Open;
+	}
+
+	hasLastCell = false;
+	filling = pressedKeys.contains(Qt::Key_B);
+	return filling && grid.isValidCell(cursorPos) && fill(cursorPos);
+}
+
+void GridPainter::keyPressed(Qt::Key key)
+{
+	pressedKeys.insert(key);
+}
+void GridPainter::keyReleased(Qt::Key key)
+{
+	pressedKeys.remove(key);
+}
+
+bool GridPainter::paint(const QPoint &cursorPos)
+{
+	if (filling)
+		return false;
+
+	//off the grid there's nothing to draw a line from, so the next stroke starts fresh
+	if (!grid.isValidCell(cursorPos))
+	{
+		hasLastCell = false;
+		return false;
+	}
+
+	bool changed = false;
+	QVector<QPoint> line = HexGrid::getLine(hasLastCell ? lastCell : cursorPos, cursorPos);
+	for (const QPoint &cell : line)
+	{
+		changed |= stamp(cell);
+	}
+
+	lastCell = cursorPos;
+	hasLastCell = true;
+	return changed;
+}
+
+void GridPainter::setBrushRadius(int radius)
+{
+	brushRadius = qBound(0, radius, MAX_BRUSH_RADIUS);
+}
+
+int GridPainter::getBrushRadius(void) const
+{
+	return brushRadius;
+}
+
+bool GridPainter::stamp(const QPoint &center)
+{
+	bool changed = false;
+	for (const QPoint &cell : HexGrid::getCellsInRadius(center, brushRadius))
+	{
+		if (grid.isValidCell(cell) && grid.getEntry(cell).type != paintMode)
+		{
+			grid.setType(cell, paintMode);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+bool GridPainter::fill(const QPoint &start)
+{
+	GridEntry::EntryType regionType = grid.getEntry(start).type;
+	if (regionType == paintMode)
+		return false;
+
+	//find the whole region first, one wavefront at a time. only the types are read while it's being found,
+	//so large wavefronts are split into chunks and expanded in parallel, with each cell claimed by whichever chunk reaches it first
+	std::unique_ptr<std::atomic<bool>[]> visited(new std::atomic<bool>[grid.getCellCount()]);
+	for (int i = 0; i < grid.getCellCount(); i++)
+	{
+		visited[i].store(false, std::memory_order_relaxed);
+	}
+	visited[grid.getIndex(start)].store(true, std::memory_order_relaxed);
+
+	std::vector<QPoint> region;
+	std::vector<QPoint> frontier(1, start);
+	while (!frontier.empty())
+	{
+		region.insert(region.end(), frontier.begin(), frontier.end());
+
+		std::vector<QPoint> next;
+		if (frontier.size() < PARALLEL_FRONTIER_SIZE)
+		{
+			expandFrontier(frontier.data(), frontier.data() + frontier.size(), regionType, visited.get(), next);
+		}
+		else
+		{
+			struct Chunk
+			{
+				const QPoint *first;
+				const QPoint *last;
+				std::vector<QPoint> next;
+			};
+
+			QVector<Chunk> chunks;
+			for (size_t begin = 0; begin < frontier.size(); begin += FRONTIER_CHUNK_SIZE)
+			{
+				size_t end = std::min(begin + FRONTIER_CHUNK_SIZE, frontier.size());
+				chunks.append(Chunk{ frontier.data() + begin, frontier.data() + end, std::vector<QPoint>() });
+			}
+
+			std::atomic<bool> *visitedCells = visited.get();
+			QtConcurrent::blockingMap(chunks, [this, regionType, visitedCells](Chunk &chunk)
+			{
+				expandFrontier(chunk.first, chunk.last, regionType, visitedCells, chunk.next);
+			});
+
+			for (const Chunk &chunk : chunks)
+			{
+				next.insert(next.end(), chunk.next.begin(), chunk.next.end());
+			}
+		}
+
+		frontier.swap(next);
+	}
+
+	//changing a type also updates the neighbors' passable masks, so the changes themselves are made on this thread
+	for (const QPoint &cell : region)
+	{
+		grid.setType(cell, paintMode);
+	}
+	return true;
+}
+
+void GridPainter::expandFrontier(const QPoint *first, const QPoint *last, GridEntry::EntryType regionType,
+	std::atomic<bool> *visited, std::vector<QPoint> &next) const
+{
+	for (const QPoint *cell = first; cell != last; ++cell)
+	{
+		for (int direction = 0; direction < grid.getNeighborCount(); direction++)
+		{
+			QPoint neighbor = *cell + grid.getNeighborOffset(direction);
+			if (grid.isValidCell(neighbor) && grid.getEntry(neighbor).type == regionType
+				&& !visited[grid.getIndex(neighbor)].exchange(true, std::memory_order_relaxed))
+			{
+				next.push_back(neighbor);
+			}
+		}
+	}
+}
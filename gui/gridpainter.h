@@ -0,0 +1,52 @@
+#ifndef GRIDPAINTER_H
+#define GRIDPAINTER_H
+
+#include <QKeyEvent>
+
+#include <atomic>
+#include <vector>
+
+#include "hexgrid/hexgrid.h"
+
+class GridPainter
+{
+public:
+	explicit GridPainter(HexGrid &grid);
+
+	//begins a stroke at the given cell. if B is held, the region of cells connected to it with the same type is filled instead
+	//start and paint return true if they changed any cell
+	bool start(const QPoint &cursorPos);
+	void keyPressed(Qt::Key key);
+	void keyReleased(Qt::Key key);
+
+	//continues the stroke to the given cell, painting every cell on the line from the last one so fast drags don't leave gaps
+	bool paint(const QPoint &cursorPos);
+
+	//the brush paints every cell within this many steps of the cursor
+	void setBrushRadius(int radius);
+	int getBrushRadius(void) const;
+
+private:
+	bool stamp(const QPoint &center);
+	bool fill(const QPoint &start);
+
+	//adds the unvisited neighbors of the given cells that have the region type to 'next', marking them visited
+	void expandFrontier(const QPoint *first, const QPoint *last, GridEntry::EntryType regionType,
+		std::atomic<bool> *visited, std::vector<QPoint> &next) const;
+
+	HexGrid &grid;
+
+	QSet<Qt::Key> pressedKeys;
+	GridEntry::EntryType paintMode;
+
+	int brushRadius;
+
+	//the cell the stroke last reached. the stroke is broken when the cursor leaves the grid
+	QPoint lastCell;
+	bool hasLastCell;
+
+	//a fill happens once when the stroke starts, and dragging afterwards doesn't paint
+	bool filling;
+};
+
+#endif // GRIDPAINTER_H
@@ -0,0 +1,29 @@
+QT       += core gui widgets concurrent
+
+TARGET = SearchVisualizer
+TEMPLATE = app
+
+CONFIG += c++11
+
+include(../searchcore/searchcore.pri)
+
+
+SOURCES += \
+    graphicswidget.cpp \
+    main.cpp \
+    mainwindow.cpp \
+    gridpainter.cpp \
+    searchplayback.cpp \
+    enginecomparison.cpp \
+    performancehud.cpp
+
+HEADERS  += \
+    graphicswidget.h \
+    mainwindow.h \
+    gridpainter.h \
+    searchplayback.h \
+    enginecomparison.h \
+    performancehud.h
+
+FORMS    += \
+    mainwindow.ui
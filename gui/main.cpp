@@ -0,0 +1,24 @@
+#include "mainwindow.h"
+#include <QApplication>
+
+#include "utils/traceevents.h"
+
+int main(int argc, char *argv[])
+{
+	//set SEARCH_TRACE to a file name to record timing spans from every thread, see utils/traceevents.h
+	TraceEvents::enableFromEnvironment();
+	TRACE_THREAD_NAME("gui");
+
+	QApplication a(argc, argv);
+	MainWindow w;
+	w.show();
+
+	int result = a.exec();
+
+	QString errorMessage;
+	if (!TraceEvents::flush(errorMessage))
+	{
+		qWarning("%s", qPrintable(errorMessage));
+	}
+	return result;
+}
@@ -0,0 +1,604 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+
+#include <cmath>
+
+#include <QtConcurrent>
+#include <QFileDialog>
+#include <QGuiApplication>
+#include <QHBoxLayout>
+#include <QLayout>
+#include <QMessageBox>
+#include <QScreen>
+#include <QThread>
+#include <QTimer>
+
+#include "enginecomparison.h"
+#include "graphicswidget.h"
+#include "gridpainter.h"
+#include "searchplayback.h"
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/hexgrid.h"
+#include "hexgrid/searchtrace.h"
+#include "utils/traceevents.h"
+
+MainWindow::MainWindow(QWidget *parent) :
+		QWidget(parent),
+        ui(new Ui::MainWindow()),
+		graphicsWidget(new GraphicsWidget(this)),
+		comparisonLayout(new QHBoxLayout()),
+        grid(new HexGrid(this, 50, 40)),
+
+        searchTimer(new QTimer(this)),
+		strokeTimer(new QTimer(this)),
+
+        painter(new GridPainter(*grid)),
+		//keep at least two workers, so a comparison can run its engines side by side
+		searchService(new SearchService(qMax(2, QThread::idealThreadCount()))),
+		searchChannel(nullptr),
+		playback(nullptr),
+		comparison(nullptr),
+
+		framesPerSecond(60),
+
+		leftMouseButton(false),
+		rightMouseButton(false),
+		hudVisible(false),
+		showOpenSet(false)
+{
+	ui->setupUi(this);
+
+	//draw one frame per screen refresh, rather than as fast as the search can produce events
+	QScreen *screen = QGuiApplication::primaryScreen();
+	if (screen != nullptr && screen->refreshRate() > 0)
+	{
+		framesPerSecond = screen->refreshRate();
+	}
+	searchTimer->setTimerType(Qt::PreciseTimer);
+
+	strokeTimer->setSingleShot(true);
+	strokeTimer->setInterval(qMax(1, int(1000 / framesPerSecond)));
+	connect(strokeTimer, &QTimer::timeout, [this]()
+	{
+		graphicsWidget->draw(grid);
+	});
+
+	layout()->addWidget(graphicsWidget);
+	ui->verticalLayout->addLayout(comparisonLayout);
+
+	graphicsWidget->draw(grid);
+
+	connect(searchTimer, &QTimer::timeout,
+		this, &MainWindow::on_searchTimer_timeout);
+}
+
+MainWindow::~MainWindow()
+{
+	cancelSearch();
+}
+
+
+void MainWindow::on_searchTimer_timeout(void)
+{
+	TRACE_SCOPE("MainWindow::on_searchTimer_timeout");
+
+	//pace playback by the real time between frames, so a late timer doesn't slow the replay down
+	double seconds = frameClock.restart() / 1000.0;
+
+	if (comparison != nullptr)
+	{
+		if (!comparison->update(seconds))
+		{
+			searchTimer->stop();
+		}
+		return;
+	}
+
+	size_t eventsApplied = 0;
+
+	if (searchChannel != nullptr)
+	{
+		//take everything that's currently in the search channel without waiting, and add it to the log
+		std::vector<GridSearchEvent> searchEvents;
+		searchChannel->tryPopAll(searchEvents);
+
+		//the search closes the channel after its last event, so once it's closed, anything left is already in the channel
+		if (searchEvents.empty() && searchChannel->isBackClosed() && searchChannel->tryPopAll(searchEvents) == 0)
+		{
+			searchChannel = nullptr;
+		}
+		playback->append(searchEvents);
+	}
+
+	if (playback != nullptr)
+	{
+		size_t positionBefore = playback->getPosition();
+		playback->advance(seconds);
+		eventsApplied = playback->getPosition() - positionBefore;
+
+		//once the search is done and there's nothing left to play, there's no reason to keep waking up
+		if (searchChannel == nullptr && (playback->isPaused() || playback->isAtEnd()))
+		{
+			searchTimer->stop();
+		}
+	}
+
+	graphicsWidget->draw(grid);
+
+	if (hudVisible)
+	{
+		hud.addFrame(seconds, eventsApplied, graphicsWidget->getDrawnCellCount());
+		if (hud.isSampleDue())
+		{
+			updateHud();
+		}
+	}
+}
+
+void MainWindow::toggleHud(void)
+{
+	hudVisible = !hudVisible;
+
+	if (hudVisible)
+	{
+		QList<QPair<QString, QString>> controls;
+		controls.append(qMakePair(QString("Enter"), QString("start search")));
+		controls.append(qMakePair(QString("Space"), QString("pause")));
+		controls.append(qMakePair(QString("+ / -"), QString("playback speed")));
+		controls.append(qMakePair(QString("T"), QString("pace mode")));
+		controls.append(qMakePair(QString("F"), QString("fit to screen")));
+		controls.append(qMakePair(QString("P"), QString("palette mode")));
+		controls.append(qMakePair(QString("[ / ]"), QString("brush size")));
+		controls.append(qMakePair(QString("B"), QString("fill region")));
+		controls.append(qMakePair(QString("H"), QString("hide overlay")));
+		graphicsWidget->setControls(controls);
+
+		hud.reset();
+		updateHud();
+	}
+	else
+	{
+		graphicsWidget->setControls(QList<QPair<QString, QString>>());
+		graphicsWidget->setDiagnostics(QList<QPair<QString, QString>>());
+	}
+}
+
+void MainWindow::updateHud(void)
+{
+	PerformanceHud::Gauges gauges;
+	gauges.channelSize = searchChannel != nullptr ? searchChannel->getSize() : 0;
+	gauges.channelCapacity = searchChannel != nullptr ? searchChannel->getCapacity() : 0;
+	gauges.channelMetrics = searchChannel != nullptr ? searchChannel->getMetrics() : ChannelMetrics::Snapshot();
+	gauges.producerBlockedSeconds = searchChannel != nullptr ? std::chrono::duration<double>(searchChannel->getBlockedTime()).count() : 0;
+	gauges.searchExpanded = searchProgress != nullptr ? searchProgress->load(std::memory_order_relaxed) : 0;
+	gauges.gridBytes = grid->getMemoryUsage();
+	gauges.playbackBytes = playback != nullptr ? playback->getMemoryUsage() : 0;
+
+	graphicsWidget->setDiagnostics(hud.sample(gauges));
+}
+
+
+
+void MainWindow::mousePressEvent(QMouseEvent *event)
+{
+	if (event->button() == Qt::LeftButton)
+	{
+		leftMouseButton = true;
+
+		//a fill changes the grid as soon as the stroke starts, so don't start one while the grid is being searched
+		if (!searchTimer->isActive() && comparison == nullptr)
+		{
+			QPoint pickedCell = graphicsWidget->pickCell(graphicsWidget->mapFromGlobal(QCursor::pos()));
+			if (painter->start(pickedCell))
+			{
+				drawStroke();
+			}
+		}
+
+		mouseMoveEvent(event);
+	}
+	else if (event->button() == Qt::RightButton)
+	{
+		//dragging with the right button pans the view
+		rightMouseButton = true;
+		lastMousePos = event->pos();
+	}
+}
+
+void MainWindow::mouseReleaseEvent(QMouseEvent *event)
+{
+	if (event->button() == Qt::LeftButton)
+	{
+		leftMouseButton = false;
+	}
+	else if (event->button() == Qt::RightButton)
+	{
+		rightMouseButton = false;
+	}
+}
+
+void MainWindow::mouseMoveEvent(QMouseEvent *event)
+{
+	if (rightMouseButton && comparison == nullptr)
+	{
+		graphicsWidget->pan(event->pos() - lastMousePos);
+		lastMousePos = event->pos();
+	}
+
+	if (leftMouseButton && !searchTimer->isActive() && comparison == nullptr)
+	{
+		QPoint pickedCell = graphicsWidget->pickCell(graphicsWidget->mapFromGlobal(QCursor::pos()));
+		if (painter->paint(pickedCell))
+		{
+			drawStroke();
+		}
+	}
+}
+
+void MainWindow::drawStroke(void)
+{
+	//mouse moves come in much faster than the screen refreshes, so everything painted until the next frame is drawn at once
+	//the timer only runs when a cell was painted, so moving the mouse without painting doesn't redraw anything
+	if (!strokeTimer->isActive())
+	{
+		strokeTimer->start();
+	}
+}
+
+void MainWindow::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event)
+}
+
+void MainWindow::keyPressEvent(QKeyEvent *event)
+{
+	if (comparison != nullptr)
+	{
+		comparisonKeyPressed(event);
+		return;
+	}
+
+	//ctrl+s and ctrl+o would otherwise start painting start and open cells
+	if (event->modifiers() & Qt::ControlModifier)
+	{
+		if (event->key() == Qt::Key_S)
+			saveTrace();
+		else if (event->key() == Qt::Key_O)
+			loadTrace();
+		return;
+	}
+
+	switch (event->key())
+	{
+	case Qt::Key_W:
+	case Qt::Key_S:
+    case Qt::Key_G:
+    case Qt::Key_O:
+	case Qt::Key_B:
+		painter->keyPressed((Qt::Key)event->key());
+		break;
+
+	case Qt::Key_BracketLeft:
+	case Qt::Key_BracketRight:
+		painter->setBrushRadius(painter->getBrushRadius() + (event->key() == Qt::Key_BracketRight ? 1 : -1));
+		break;
+
+	case Qt::Key_Return:
+	case Qt::Key_Enter:
+		startSearch();
+		break;
+
+	case Qt::Key_Space:
+		togglePauseSearch();
+		break;
+
+	//everything below only does something once a search has been started
+	case Qt::Key_Right:
+	case Qt::Key_Left:
+		if (playback != nullptr)
+			seekSearch(qint64(playback->getPosition()) + (event->key() == Qt::Key_Right ? 1 : -1));
+		break;
+
+	case Qt::Key_Home:
+		seekSearch(0);
+		break;
+
+	case Qt::Key_End:
+		if (playback != nullptr)
+			seekSearch(qint64(playback->getLength()));
+		break;
+
+	case Qt::Key_PageUp:
+	case Qt::Key_PageDown:
+		if (playback != nullptr)
+		{
+			qint64 jump = qMax(qint64(1), qint64(playback->getLength() / 10));
+			seekSearch(qint64(playback->getPosition()) + (event->key() == Qt::Key_PageDown ? jump : -jump));
+		}
+		break;
+
+	case Qt::Key_Plus:
+	case Qt::Key_Equal:
+	case Qt::Key_Up:
+		if (playback != nullptr)
+			playback->setEventsPerFrame(qMin(playback->getEventsPerFrame() * 2, 1048576.0));
+		break;
+
+	case Qt::Key_Minus:
+	case Qt::Key_Down:
+		if (playback != nullptr)
+			playback->setEventsPerFrame(qMax(playback->getEventsPerFrame() / 2, 1.0 / 64));
+		break;
+
+	case Qt::Key_T:
+		if (playback != nullptr)
+			playback->setPaceMode(playback->getPaceMode() == SearchPlayback::EVENTS_PER_FRAME ? SearchPlayback::FIXED_DURATION : SearchPlayback::EVENTS_PER_FRAME);
+		break;
+
+	case Qt::Key_C:
+		startComparison();
+		break;
+
+	case Qt::Key_F:
+		graphicsWidget->resetView();
+		break;
+
+	case Qt::Key_H:
+		toggleHud();
+		break;
+
+	case Qt::Key_Q:
+		showOpenSet = !showOpenSet;
+		break;
+
+	case Qt::Key_P:
+		graphicsWidget->setRenderMode(graphicsWidget->getRenderMode() == GraphicsWidget::SpriteRender ? GraphicsWidget::PaletteRender : GraphicsWidget::SpriteRender);
+		break;
+
+	case Qt::Key_Delete:
+	case Qt::Key_Backspace:
+		cancelSearch();
+		break;
+
+
+	case Qt::Key_Escape:
+		cancelSearch();
+		grid->resetAll();
+		break;
+	}
+}
+
+void MainWindow::keyReleaseEvent(QKeyEvent *event)
+{
+	switch (event->key())
+	{
+    case Qt::Key_W:
+    case Qt::Key_S:
+    case Qt::Key_G:
+    case Qt::Key_O:
+	case Qt::Key_B:
+		painter->keyReleased((Qt::Key)event->key());
+		break;
+	}
+}
+
+void MainWindow::wheelEvent(QWheelEvent *event)
+{
+	if (comparison != nullptr)
+		return;
+
+	//each notch of the wheel zooms by a quarter, centered on the cursor
+	double notches = event->angleDelta().y() / 120.0;
+	graphicsWidget->zoomAt(graphicsWidget->mapFromGlobal(event->globalPos()), std::pow(1.25, notches));
+}
+
+void MainWindow::startSearch(void)
+{
+	cancelSearch();
+	startPlayback();
+
+	std::vector<QPoint> startStates, goalStates;
+	GridSearcher::findEndpoints(*grid, startStates, goalStates);
+
+	//run the search on one of the service's workers, which reuses its memory from one search to the next
+	searchToken = CancellationToken();
+	searchProgress = std::make_shared<std::atomic<size_t>>(0);
+	searchFuture = searchService->submit(*grid, GridSearcher::ASTAR, startStates, goalStates, searchToken, searchChannel,
+		showOpenSet ? GridSearcher::OPEN_SET : GridSearcher::EXPANSIONS, searchProgress);
+}
+
+void MainWindow::startPlayback(void)
+{
+	//the channel's blocked time starts over with the new channel, and the expansions with the new search
+	hud.reset();
+	searchProgress = nullptr;
+
+	//create a new channel to put results into. the search thread is its only producer and we're its only consumer
+	//it's big enough that the search never has to wait for the next frame, since playback is paced separately
+	searchChannel = std::make_shared<SpscChannel<GridSearchEvent>>(
+		SpscChannel<GridSearchEvent>::BLOCK, 1 << 16);
+	searchChannel->enableMetrics();
+
+	playback = std::unique_ptr<SearchPlayback>(new SearchPlayback(*grid, framesPerSecond));
+
+	//start the timer that will pull results out and play them back once per screen refresh
+	frameClock.start();
+	searchTimer->start(qMax(1, int(1000 / framesPerSecond)));
+}
+
+void MainWindow::cancelSearch(void)
+{
+	if (searchChannel != nullptr)
+	{
+		//we won't be using any more of the results of the search, so just close the channel
+		searchChannel->closeFront();
+		searchChannel = nullptr;
+	}
+
+	//the search reads from the grid, so stop it and wait until it lets go before the grid is touched again
+	searchToken.cancel();
+	if (searchFuture.valid())
+	{
+		searchFuture.wait();
+		searchFuture = std::future<SearchService::Result>();
+	}
+
+	//a replay only reads the trace, but it's still waited for, so nothing is left running once the window is gone
+	replayFuture.waitForFinished();
+	replayFuture = QFuture<bool>();
+
+	//stop the search timer
+	searchTimer->stop();
+	playback = nullptr;
+
+	//wipe all the search results from the grid
+	grid->resetSearched();
+
+	//redraw the grid
+	graphicsWidget->draw(grid);
+}
+
+void MainWindow::togglePauseSearch(void)
+{
+	if (playback == nullptr)
+		return;
+
+	playback->setPaused(!playback->isPaused());
+
+	if (!playback->isPaused() && !searchTimer->isActive())
+	{
+		frameClock.start();
+		searchTimer->start();
+	}
+}
+
+void MainWindow::seekSearch(qint64 position)
+{
+	if (playback == nullptr)
+		return;
+
+	playback->setPaused(true);
+	playback->seek(size_t(qMax(qint64(0), position)));
+
+	graphicsWidget->draw(grid);
+}
+
+void MainWindow::saveTrace(void)
+{
+	if (playback == nullptr)
+		return;
+
+	QString fileName = QFileDialog::getSaveFileName(this, "Save Search Trace", QString(), "Search traces (*.hxtrace)");
+	if (fileName.isEmpty())
+		return;
+
+	QString errorMessage;
+	if (!SearchTraceWriter::save(fileName, *grid, playback->getEvents(), errorMessage))
+	{
+		QMessageBox::warning(this, "Save Search Trace", errorMessage);
+	}
+}
+
+void MainWindow::loadTrace(void)
+{
+	QString fileName = QFileDialog::getOpenFileName(this, "Load Search Trace", QString(), "Search traces (*.hxtrace)");
+	if (fileName.isEmpty())
+		return;
+
+	//the reader has to stay alive until the replay thread is done with it
+	std::shared_ptr<SearchTraceReader> reader = std::make_shared<SearchTraceReader>();
+
+	QString errorMessage;
+	std::unique_ptr<HexGrid> tracedGrid;
+	if (reader->open(fileName, errorMessage))
+	{
+		tracedGrid = reader->createGrid();
+		if (tracedGrid == nullptr)
+			errorMessage = QString("%1 is not a valid search trace").arg(fileName);
+	}
+
+	if (tracedGrid == nullptr)
+	{
+		QMessageBox::warning(this, "Load Search Trace", errorMessage);
+		return;
+	}
+
+	if (tracedGrid->getWidth() != grid->getWidth() || tracedGrid->getHeight() != grid->getHeight())
+	{
+		QMessageBox::warning(this, "Load Search Trace",
+			QString("%1 was recorded on a %2x%3 grid").arg(fileName).arg(tracedGrid->getWidth()).arg(tracedGrid->getHeight()));
+		return;
+	}
+
+	//put the walls, starts and goals back the way they were when the search was recorded
+	cancelSearch();
+	for (const QPoint &cell : grid->getCells())
+	{
+		grid->setType(cell, tracedGrid->getEntry(cell).type);
+	}
+
+	startPlayback();
+
+	//replay the trace on a pool thread. cancelSearch closes the channel's front, which stops the replay, and waits for it
+	std::shared_ptr<SpscChannel<GridSearchEvent>> channel = searchChannel;
+	replayFuture = QtConcurrent::run([reader, channel]()
+	{
+		return reader->replay(channel);
+	});
+}
+
+void MainWindow::startComparison(void)
+{
+	cancelSearch();
+
+	//the comparison views take the place of the normal one until the comparison ends
+	graphicsWidget->hide();
+
+	std::vector<GridSearcher::Engine> engines = { GridSearcher::ASTAR, GridSearcher::DIJKSTRA };
+	comparison = std::unique_ptr<EngineComparison>(new EngineComparison(*searchService, *grid, engines, this, comparisonLayout, framesPerSecond));
+
+	frameClock.start();
+	searchTimer->start(qMax(1, int(1000 / framesPerSecond)));
+}
+
+void MainWindow::endComparison(void)
+{
+	searchTimer->stop();
+	comparison = nullptr;
+
+	graphicsWidget->show();
+	graphicsWidget->draw(grid);
+}
+
+void MainWindow::comparisonKeyPressed(QKeyEvent *event)
+{
+	switch (event->key())
+	{
+	case Qt::Key_Space:
+		comparison->togglePaused();
+		if (!searchTimer->isActive())
+		{
+			frameClock.start();
+			searchTimer->start();
+		}
+		break;
+
+	case Qt::Key_Plus:
+	case Qt::Key_Equal:
+	case Qt::Key_Up:
+		comparison->scaleEventsPerFrame(2);
+		break;
+
+	case Qt::Key_Minus:
+	case Qt::Key_Down:
+		comparison->scaleEventsPerFrame(0.5);
+		break;
+
+	case Qt::Key_C:
+	case Qt::Key_Escape:
+	case Qt::Key_Delete:
+	case Qt::Key_Backspace:
+		endComparison();
+		break;
+	}
+}
@@ -0,0 +1,122 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QWidget>
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+#include "performancehud.h"
+#include "hexgrid/gridsearchevent.h"
+#include "hexgrid/searchservice.h"
+#include "utils/cancellationtoken.h"
+#include "utils/spscchannel.h"
+
+class QTimer;
+class QHBoxLayout;
+
+class GraphicsWidget;
+class GridPainter;
+class HexGrid;
+class SearchPlayback;
+class EngineComparison;
+
+namespace Ui {
+	class MainWindow;
+}
+
+class MainWindow : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit MainWindow(QWidget *parent = 0);
+	~MainWindow();
+
+private:
+	void on_searchTimer_timeout(void);
+
+	void mousePressEvent(QMouseEvent *event);
+	void mouseReleaseEvent(QMouseEvent *event);
+	void mouseMoveEvent(QMouseEvent *event);
+	void mouseDoubleClickEvent(QMouseEvent *event);
+
+	//draws the cells painted by the stroke at the next frame
+	void drawStroke(void);
+
+	void keyPressEvent(QKeyEvent *event);
+	void keyReleaseEvent(QKeyEvent *event);
+
+	void wheelEvent(QWheelEvent *event);
+
+	void startSearch(void);
+
+	//creates a new search channel and plays back whatever is put into it. whoever fills the channel must close its back
+	void startPlayback(void);
+	void togglePauseSearch(void);
+	void cancelSearch(void);
+
+	//moves playback to the given event, pausing it first
+	void seekSearch(qint64 position);
+
+	//save the events played back so far, or replay a saved search on this grid
+	void saveTrace(void);
+	void loadTrace(void);
+
+	//run every engine at once on the current grid, side by side, in place of the normal view
+	void startComparison(void);
+	void endComparison(void);
+	void comparisonKeyPressed(QKeyEvent *event);
+
+	//the performance overlay. it's sampled from the frame timer a few times a second, so painting only draws text it's given
+	void toggleHud(void);
+	void updateHud(void);
+
+
+	std::unique_ptr<Ui::MainWindow> ui;
+
+	GraphicsWidget *graphicsWidget;
+	QHBoxLayout *comparisonLayout;
+	HexGrid *grid;
+
+	QTimer *searchTimer;
+
+	//draws the cells painted since the last frame, once per frame
+	QTimer *strokeTimer;
+
+	std::unique_ptr<GridPainter> painter;
+	//searches run on the service's workers, and the grid can't be changed until the current one is done with it
+	std::unique_ptr<SearchService> searchService;
+	CancellationToken searchToken;
+	std::future<SearchService::Result> searchFuture;
+
+	//the number of states the running search has expanded, which the search thread keeps up to date for the HUD
+	std::shared_ptr<std::atomic<size_t>> searchProgress;
+
+	//a loaded trace is replayed into the search channel on a pool thread, which stops once the channel's front is closed
+	QFuture<bool> replayFuture;
+	std::shared_ptr<SpscChannel<GridSearchEvent>> searchChannel;
+	std::unique_ptr<SearchPlayback> playback;
+	std::unique_ptr<EngineComparison> comparison;
+
+	//the refresh rate of the screen we're on, and the time since the last frame
+	double framesPerSecond;
+	QElapsedTimer frameClock;
+
+	bool leftMouseButton;
+
+	//the right button pans the view, by however far the mouse moved since lastMousePos
+	bool rightMouseButton;
+	QPoint lastMousePos;
+
+	bool hudVisible;
+	PerformanceHud hud;
+
+	//whether the next search also reports each cell as it's added to the open set
+	bool showOpenSet;
+};
+
+#endif // MAINWINDOW_H
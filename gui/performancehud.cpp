@@ -0,0 +1,84 @@
+#include "performancehud.h"
+
+namespace {
+	//how often the lines are rebuilt
+	const qint64 SAMPLE_MILLISECONDS = 250;
+}
+
+PerformanceHud::PerformanceHud(void)
+{
+	reset();
+}
+
+void PerformanceHud::addFrame(double seconds, size_t applied, int drawn)
+{
+	frames++;
+	frameSeconds += seconds;
+	slowestFrame = qMax(slowestFrame, seconds);
+	eventsApplied += applied;
+	cellsDrawn += drawn;
+}
+
+bool PerformanceHud::isSampleDue(void) const
+{
+	return sampleClock.elapsed() >= SAMPLE_MILLISECONDS;
+}
+
+QList<QPair<QString, QString>> PerformanceHud::sample(const Gauges &gauges)
+{
+	double elapsed = qMax(sampleClock.restart() / 1000.0, 0.001);
+
+	//the blocked time is a running total, so only the part since the last sample counts towards this one
+	double blocked = qMax(0.0, gauges.producerBlockedSeconds - lastBlockedSeconds);
+	lastBlockedSeconds = gauges.producerBlockedSeconds;
+
+	//the expansions come from the search thread, so they show how fast it searches, not how fast we take its events
+	size_t expanded = gauges.searchExpanded >= lastSearchExpanded ? gauges.searchExpanded - lastSearchExpanded : 0;
+	lastSearchExpanded = gauges.searchExpanded;
+
+	double averageFrame = frames > 0 ? frameSeconds / frames : 0;
+
+	QList<QPair<QString, QString>> lines;
+	lines.append(qMakePair(QString("Frame time"), QString("%1 ms").arg(averageFrame * 1000, 0, 'f', 2)));
+	lines.append(qMakePair(QString("Slowest frame"), QString("%1 ms").arg(slowestFrame * 1000, 0, 'f', 2)));
+	lines.append(qMakePair(QString("FPS"), QString::number(frames / elapsed, 'f', 1)));
+	lines.append(qMakePair(QString("Events shown/sec"), QString::number(qint64(eventsApplied / elapsed))));
+	lines.append(qMakePair(QString("Expansions/sec"), QString::number(qint64(expanded / elapsed))));
+	lines.append(qMakePair(QString("Channel depth"), QString("%1 / %2").arg(qulonglong(gauges.channelSize)).arg(qulonglong(gauges.channelCapacity))));
+	lines.append(qMakePair(QString("Channel peak"), QString::number(qulonglong(gauges.channelMetrics.highWaterMark))));
+	lines.append(qMakePair(QString("Search waits"), QString::number(qulonglong(gauges.channelMetrics.producerWaits))));
+	lines.append(qMakePair(QString("Search blocked"), QString("%1%").arg(100 * qMin(1.0, blocked / elapsed), 0, 'f', 1)));
+	lines.append(qMakePair(QString("Cells drawn/frame"), QString::number(frames > 0 ? cellsDrawn / frames : 0)));
+	lines.append(qMakePair(QString("Grid memory"), formatBytes(gauges.gridBytes)));
+	lines.append(qMakePair(QString("Playback memory"), formatBytes(gauges.playbackBytes)));
+
+	frames = 0;
+	frameSeconds = 0;
+	slowestFrame = 0;
+	eventsApplied = 0;
+	cellsDrawn = 0;
+
+	return lines;
+}
+
+void PerformanceHud::reset(void)
+{
+	sampleClock.start();
+
+	frames = 0;
+	frameSeconds = 0;
+	slowestFrame = 0;
+	eventsApplied = 0;
+	cellsDrawn = 0;
+
+	lastBlockedSeconds = 0;
+	lastSearchExpanded = 0;
+}
+
+QString PerformanceHud::formatBytes(size_t bytes)
+{
+	if (bytes >= 1024 * 1024)
+		return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+	else
+		return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+}
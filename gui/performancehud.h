@@ -0,0 +1,62 @@
+#ifndef PERFORMANCEHUD_H
+#define PERFORMANCEHUD_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include "utils/channelmetrics.h"
+
+//collects timing and throughput numbers from the main window's frame loop, and turns them into diagnostic lines
+//each frame only adds a few numbers together. the text is only rebuilt a few times a second, and never while painting
+class PerformanceHud
+{
+public:
+	//numbers that are read when a sample is taken, rather than added up every frame
+	struct Gauges
+	{
+		size_t channelSize;
+		size_t channelCapacity;
+		ChannelMetrics::Snapshot channelMetrics;
+
+		//the total time the search has spent blocked on a full channel
+		double producerBlockedSeconds;
+
+		//the number of states the search has expanded so far, as counted by the search thread
+		size_t searchExpanded;
+
+		size_t gridBytes;
+		size_t playbackBytes;
+	};
+
+	PerformanceHud(void);
+
+	//record one frame. eventsApplied is the number of events playback moved forward, and cellsDrawn comes from the graphics widget
+	void addFrame(double seconds, size_t eventsApplied, int cellsDrawn);
+
+	//true once enough time has passed since the last sample that the lines are worth rebuilding
+	bool isSampleDue(void) const;
+
+	//turn the frames recorded since the last sample into label/value lines, and start a new sample
+	QList<QPair<QString, QString>> sample(const Gauges &gauges);
+
+	//start over, for a new search whose channel starts out with no blocked time and no expansions
+	void reset(void);
+
+private:
+	static QString formatBytes(size_t bytes);
+
+	QElapsedTimer sampleClock;
+
+	int frames;
+	double frameSeconds;
+	double slowestFrame;
+	size_t eventsApplied;
+	qint64 cellsDrawn;
+
+	double lastBlockedSeconds;
+	size_t lastSearchExpanded;
+};
+
+#endif // PERFORMANCEHUD_H
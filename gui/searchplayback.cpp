@@ -0,0 +1,212 @@
+#include "searchplayback.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "hexgrid/hexgrid.h"
+
+namespace {
+	//keyframes are never closer together than this, so small grids don't spend their time taking snapshots
+	const size_t MIN_KEYFRAME_INTERVAL = 4096;
+}
+
+SearchPlayback::SearchPlayback(HexGrid &grid, double framesPerSecond)
+	:grid(grid), framesPerSecond(framesPerSecond), cells(grid.getCells()), position(0),
+	logState(grid.getCellCount(), 0),
+	paused(false), paceMode(EVENTS_PER_FRAME), eventsPerFrame(4), replayDuration(10), eventBudget(0)
+{
+	//a keyframe costs one byte per cell, so spacing them one grid size apart keeps them at about one byte per event
+	//seeking then costs one pass over the grid plus at most one interval of events
+	keyframeInterval = std::max(MIN_KEYFRAME_INTERVAL, size_t(grid.getCellCount()));
+
+	//the first keyframe is the empty grid
+	keyframes.push_back(logState);
+}
+
+void SearchPlayback::append(const std::vector<GridSearchEvent> &newEvents)
+{
+	for (const GridSearchEvent &event : newEvents)
+	{
+		//the events can come from a trace file, so don't trust them to be on the grid
+		if (!grid.isValidCell(event.point))
+		{
+			continue;
+		}
+
+		quint8 &flags = logState[grid.getIndex(event.point)];
+		flags = applyEvent(flags, event.eventType);
+
+		events.push_back(event);
+
+		if (events.size() % keyframeInterval == 0)
+		{
+			keyframes.push_back(logState);
+		}
+	}
+}
+
+size_t SearchPlayback::getPosition(void) const
+{
+	return position;
+}
+
+size_t SearchPlayback::getLength(void) const
+{
+	return events.size();
+}
+
+bool SearchPlayback::isAtEnd(void) const
+{
+	return position == events.size();
+}
+
+const std::vector<GridSearchEvent> &SearchPlayback::getEvents(void) const
+{
+	return events;
+}
+
+bool SearchPlayback::isPaused(void) const
+{
+	return paused;
+}
+
+void SearchPlayback::setPaused(bool p)
+{
+	paused = p;
+	eventBudget = 0;
+}
+
+void SearchPlayback::setEventsPerFrame(double e)
+{
+	eventsPerFrame = std::max(e, 0.0);
+}
+
+double SearchPlayback::getEventsPerFrame(void) const
+{
+	return eventsPerFrame;
+}
+
+void SearchPlayback::setReplayDuration(double seconds)
+{
+	replayDuration = std::max(seconds, 0.001);
+}
+
+double SearchPlayback::getReplayDuration(void) const
+{
+	return replayDuration;
+}
+
+void SearchPlayback::setPaceMode(PaceMode mode)
+{
+	paceMode = mode;
+	eventBudget = 0;
+}
+
+size_t SearchPlayback::getMemoryUsage(void) const
+{
+	size_t bytes = events.capacity() * sizeof(GridSearchEvent) + logState.capacity();
+	for (const std::vector<quint8> &keyframe : keyframes)
+	{
+		bytes += keyframe.capacity();
+	}
+	return bytes;
+}
+
+SearchPlayback::PaceMode SearchPlayback::getPaceMode(void) const
+{
+	return paceMode;
+}
+
+void SearchPlayback::advance(double seconds)
+{
+	if (paused)
+	{
+		return;
+	}
+
+	if (paceMode == EVENTS_PER_FRAME)
+	{
+		eventBudget += eventsPerFrame * seconds * framesPerSecond;
+	}
+	else
+	{
+		//if the search is still running, the log keeps growing and playback speeds up to match
+		eventBudget += events.size() * seconds / replayDuration;
+	}
+
+	double wholeEvents = std::floor(eventBudget);
+	eventBudget -= wholeEvents;
+
+	applyForward(std::min(size_t(wholeEvents), events.size() - position));
+}
+
+void SearchPlayback::seek(size_t target)
+{
+	target = std::min(target, events.size());
+
+	//if the target is a short way ahead of us, just play up to it. otherwise start over from the closest keyframe before it
+	if (target < position || target - position > keyframeInterval)
+	{
+		restoreKeyframe(target / keyframeInterval);
+	}
+	applyForward(target - position);
+}
+
+quint8 SearchPlayback::applyEvent(quint8 flags, GridSearchEvent::EventType eventType)
+{
+	if (eventType == GridSearchEvent::EXPAND)
+		return flags | SEARCHED;
+	else if (eventType == GridSearchEvent::BACKTRACE)
+		return flags | PATH;
+	else
+		return flags | QUEUED;
+}
+
+void SearchPlayback::applyForward(size_t count)
+{
+	for (size_t end = position + count; position < end; position++)
+	{
+		const GridSearchEvent &event = events[position];
+
+		//take the info from the search event and use it to modify the grid
+		GridEntry &entry = grid.getEntry(event.point);
+		if (event.eventType == GridSearchEvent::BACKTRACE)
+		{
+			entry.path = true;
+		}
+		else if (event.eventType == GridSearchEvent::EXPAND)
+		{
+			entry.searched = true;
+		}
+		else
+		{
+			entry.queued = true;
+		}
+		grid.markModified(event.point);
+	}
+}
+
+void SearchPlayback::restoreKeyframe(size_t keyframe)
+{
+	const std::vector<quint8> &flags = keyframes[keyframe];
+
+	for (int i = 0; i < cells.size(); i++)
+	{
+		GridEntry &entry = grid.getEntry(cells[i]);
+
+		bool searched = (flags[i] & SEARCHED) != 0;
+		bool path = (flags[i] & PATH) != 0;
+		bool queued = (flags[i] & QUEUED) != 0;
+
+		//only redraw the cells that actually change
+		if (entry.searched != searched || entry.path != path || entry.queued != queued)
+		{
+			entry.searched = searched;
+			entry.path = path;
+			entry.queued = queued;
+			grid.markModified(cells[i]);
+		}
+	}
+
+	position = keyframe * keyframeInterval;
+}
@@ -0,0 +1,88 @@
+#ifndef SEARCHPLAYBACK_H
+#define SEARCHPLAYBACK_H
+
+#include <QList>
+#include <QPoint>
+#include <vector>
+
+#include "hexgrid/gridsearchevent.h"
+
+class HexGrid;
+
+//keeps a log of every event a search produced, and plays it back onto the grid at a pace that doesn't depend on how fast the search ran
+//every so often, the searched/queued/path state of the whole grid is saved as a keyframe, so seeking anywhere in the log only has to
+//restore one keyframe and replay at most one keyframe interval worth of events
+class SearchPlayback
+{
+public:
+	enum PaceMode { EVENTS_PER_FRAME, FIXED_DURATION };
+
+	SearchPlayback(HexGrid &grid, double framesPerSecond);
+
+	//add events to the end of the log. they'll be shown when playback reaches them
+	void append(const std::vector<GridSearchEvent> &events);
+
+	//the number of events currently shown on the grid, and the number of events in the log
+	size_t getPosition(void) const;
+	size_t getLength(void) const;
+	bool isAtEnd(void) const;
+
+	const std::vector<GridSearchEvent> &getEvents(void) const;
+
+	//the number of bytes the log and the keyframes hold on to, for diagnostics
+	size_t getMemoryUsage(void) const;
+
+	bool isPaused(void) const;
+	void setPaused(bool paused);
+
+	//play back a fixed number of events per frame
+	void setEventsPerFrame(double eventsPerFrame);
+	double getEventsPerFrame(void) const;
+
+	//play back the whole log in a fixed amount of time
+	void setReplayDuration(double seconds);
+	double getReplayDuration(void) const;
+
+	void setPaceMode(PaceMode mode);
+	PaceMode getPaceMode(void) const;
+
+	//move playback forward by however many events fit in the given amount of time. does nothing while paused
+	void advance(double seconds);
+
+	//show exactly the first 'position' events of the log. clamped to the length of the log
+	void seek(size_t position);
+
+private:
+	enum CellFlags { SEARCHED = 1, PATH = 2, QUEUED = 4 };
+
+	static quint8 applyEvent(quint8 flags, GridSearchEvent::EventType eventType);
+
+	void applyForward(size_t count);
+	void restoreKeyframe(size_t keyframe);
+
+	HexGrid &grid;
+	const double framesPerSecond;
+
+	//a cached copy of grid.getCells(), so cell indexes can be turned back into cells
+	QList<QPoint> cells;
+
+	std::vector<GridSearchEvent> events;
+	size_t position;
+
+	//keyframe k holds the flags of every cell after the first k * keyframeInterval events
+	size_t keyframeInterval;
+	std::vector<std::vector<quint8>> keyframes;
+
+	//the flags of every cell after every event in the log, used to build the next keyframe
+	std::vector<quint8> logState;
+
+	bool paused;
+	PaceMode paceMode;
+	double eventsPerFrame;
+	double replayDuration;
+
+	//the fraction of an event we didn't get to in the last frame
+	double eventBudget;
+};
+
+#endif // SEARCHPLAYBACK_H
@@ -0,0 +1,238 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "hexgrid/hexgrid.h"
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/movingaiimporter.h"
+
+namespace {
+	struct ScenarioResult
+	{
+		//path lengths in moves, or -1 if no path was found
+		int length;
+		int referenceLength;
+
+		//the start or goal isn't a cell of the map, so the query wasn't searched
+		bool invalid;
+
+		double milliseconds;
+	};
+
+	int pathLength(const std::vector<QPoint> &path)
+	{
+		return path.empty() ? -1 : int(path.size()) - 1;
+	}
+
+	//nearest-rank percentile of an already sorted list
+	double percentile(const std::vector<double> &sorted, double p)
+	{
+		if (sorted.empty())
+			return 0;
+
+		size_t rank = size_t(std::ceil(p * sorted.size()));
+		return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+	}
+
+	//scenario files name their map with whatever path the benchmark set was built with, so look next to the scenario file first
+	QString resolveMap(const QString &scenarioFile, const QString &mapName)
+	{
+		QString local = QFileInfo(scenarioFile).dir().filePath(QFileInfo(mapName).fileName());
+		return QFileInfo(local).exists() ? local : mapName;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("searchscenarios");
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Runs every query of a MovingAI .scen file on a hex or square grid, and checks the path lengths against a reference Dijkstra search.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("scenario", "The .scen file to run.");
+
+	QCommandLineOption mapOption("map", "The .map file to use, instead of the one named in the scenario file.", "file");
+	QCommandLineOption engineOption("engine", "Search engine to test, astar or dijkstra.", "engine", "astar");
+	QCommandLineOption threadsOption("threads", "Number of threads to run the queries on.", "count", "1");
+	QCommandLineOption verboseOption("verbose", "Print a line for every query.");
+	QCommandLineOption topologyOption("topology", "The cells to load the map as: hex, square4 or square8.", "topology", "hex");
+	parser.addOption(mapOption);
+	parser.addOption(engineOption);
+	parser.addOption(threadsOption);
+	parser.addOption(verboseOption);
+	parser.addOption(topologyOption);
+
+	parser.process(app);
+
+	if (parser.positionalArguments().size() != 1)
+	{
+		parser.showHelp(1);
+	}
+
+	GridSearcher::Engine engine;
+	if (parser.value(engineOption) == "astar")
+		engine = GridSearcher::ASTAR;
+	else if (parser.value(engineOption) == "dijkstra")
+		engine = GridSearcher::DIJKSTRA;
+	else
+	{
+		err << "Unknown engine: " << parser.value(engineOption) << endl;
+		return 1;
+	}
+
+	GridTopology topology;
+	if (!HexGrid::parseTopology(parser.value(topologyOption), topology))
+	{
+		err << "Unknown topology: " << parser.value(topologyOption) << endl;
+		return 1;
+	}
+
+	int threadCount = qMax(1, parser.value(threadsOption).toInt());
+
+	QString scenarioFile = parser.positionalArguments().first();
+	QString errorMessage;
+
+	std::vector<MovingAIImporter::Scenario> scenarios;
+	if (!MovingAIImporter::loadScenarios(scenarioFile, scenarios, errorMessage, topology))
+	{
+		err << errorMessage << endl;
+		return 1;
+	}
+
+	//load every map the scenarios refer to up front, so the worker threads only ever read them
+	QHash<QString, std::shared_ptr<HexGrid>> maps;
+	for (const MovingAIImporter::Scenario &scenario : scenarios)
+	{
+		if (!maps.contains(scenario.mapName))
+		{
+			QString mapFile = parser.isSet(mapOption) ? parser.value(mapOption) : resolveMap(scenarioFile, scenario.mapName);
+
+			std::shared_ptr<HexGrid> grid(MovingAIImporter::loadMap(mapFile, errorMessage, topology));
+			if (grid == nullptr)
+			{
+				err << errorMessage << endl;
+				return 1;
+			}
+			maps.insert(scenario.mapName, grid);
+		}
+
+		//the map given with --map, or one that's been edited since, may not be the size the scenarios were made for
+		const HexGrid &grid = *maps.value(scenario.mapName);
+		if (grid.getWidth() != scenario.mapWidth || grid.getHeight() != scenario.mapHeight)
+		{
+			err << "The map for " << scenario.mapName << " is " << grid.getWidth() << "x" << grid.getHeight()
+				<< ", but the scenarios expect " << scenario.mapWidth << "x" << scenario.mapHeight << endl;
+			return 1;
+		}
+	}
+
+	std::vector<ScenarioResult> results(scenarios.size());
+
+	std::atomic<size_t> nextScenario(0);
+	auto worker = [&]()
+	{
+		for (size_t i = nextScenario++; i < scenarios.size(); i = nextScenario++)
+		{
+			const MovingAIImporter::Scenario &scenario = scenarios[i];
+			const HexGrid &grid = *maps.value(scenario.mapName);
+
+			results[i].invalid = !grid.isValidCell(scenario.start) || !grid.isValidCell(scenario.goal);
+			if (results[i].invalid)
+			{
+				results[i].length = results[i].referenceLength = -1;
+				results[i].milliseconds = 0;
+				continue;
+			}
+
+			std::vector<QPoint> startStates(1, scenario.start);
+			std::vector<QPoint> goalStates(1, scenario.goal);
+
+			//only the engine under test is timed
+			auto begin = std::chrono::steady_clock::now();
+			std::vector<QPoint> path = GridSearcher(grid, engine).findPath(startStates, goalStates);
+			auto end = std::chrono::steady_clock::now();
+
+			std::vector<QPoint> referencePath = GridSearcher(grid, GridSearcher::DIJKSTRA).findPath(startStates, goalStates);
+
+			results[i].length = pathLength(path);
+			results[i].referenceLength = pathLength(referencePath);
+			results[i].milliseconds = std::chrono::duration<double, std::milli>(end - begin).count();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	int mismatches = 0, errors = 0;
+	std::vector<double> times;
+	times.reserve(results.size());
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const ScenarioResult &result = results[i];
+		const MovingAIImporter::Scenario &scenario = scenarios[i];
+		if (result.invalid)
+		{
+			errors++;
+			out << "query " << i
+				<< ": (" << scenario.start.x() << "," << scenario.start.y() << ") -> (" << scenario.goal.x() << "," << scenario.goal.y() << ")"
+				<< "  ERROR: start or goal is outside the map" << endl;
+			continue;
+		}
+
+		bool optimal = result.length == result.referenceLength;
+
+		if (!optimal)
+			mismatches++;
+
+		times.push_back(result.milliseconds);
+
+		if (parser.isSet(verboseOption) || !optimal)
+		{
+			out << "query " << i
+				<< ": (" << scenario.start.x() << "," << scenario.start.y() << ") -> (" << scenario.goal.x() << "," << scenario.goal.y() << ")"
+				<< ", length " << result.length << ", reference " << result.referenceLength
+				<< ", " << result.milliseconds << " ms"
+				<< (optimal ? "" : "  NOT OPTIMAL") << endl;
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double totalMilliseconds = 0;
+	for (double t : times)
+	{
+		totalMilliseconds += t;
+	}
+
+	out << results.size() << " queries, " << results.size() - mismatches - errors << " optimal, " << mismatches << " not optimal, "
+		<< errors << " errors" << endl;
+	out << "time per query (ms): mean " << (times.empty() ? 0 : totalMilliseconds / times.size())
+		<< ", p50 " << percentile(times, 0.5)
+		<< ", p90 " << percentile(times, 0.9)
+		<< ", p99 " << percentile(times, 0.99)
+		<< ", max " << (times.empty() ? 0 : times.back()) << endl;
+
+	return mismatches == 0 && errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,238 @@
+#ifndef SEARCHALGORITHMS_H
+#define SEARCHALGORITHMS_H
+
+#include <functional>
+#include <algorithm>
+#include <atomic>
+
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <queue>
+
+#include "algorithms/searchobservers.h"
+#include "utils/poolallocator.h"
+#include "utils/traceevents.h"
+
+class SearchAlgorithms
+{
+public:
+	template<class State>
+	struct SearchItem {
+		State state;
+		State parent;
+		float currentCost;
+		float estimatedTotalCost;
+
+		SearchItem(){}
+
+		SearchItem(const State &state, const State &parent, float currentCost, float estimatedTotalCost)
+			:state(state), parent(parent), currentCost(currentCost), estimatedTotalCost(estimatedTotalCost)
+		{}
+
+
+		bool operator<(const SearchItem &other) const
+		{
+			if (estimatedTotalCost != other.estimatedTotalCost)
+				return estimatedTotalCost > other.estimatedTotalCost;
+			else
+			{
+				float heuristic = estimatedTotalCost - currentCost;
+				float otherHeuristic = other.estimatedTotalCost - other.currentCost;
+
+				return heuristic > otherHeuristic;
+			}
+		}
+
+	};
+
+	//the open and closed sets of a search. keeping one around between searches means their memory is reused instead of
+	//being allocated and freed every time. only one search may use a workspace at a time
+	template<class State>
+	class Workspace
+	{
+	public:
+		Workspace(void)
+			:closedSet(0, std::hash<State>(), std::equal_to<State>(), PoolAllocator<std::pair<const State, State>>(&pool))
+		{}
+		Workspace(const Workspace &other) = delete;
+
+		void clear(void)
+		{
+			openSet.clear();
+			closedSet.clear();
+			neighbors.clear();
+
+			//the closed set is empty now, so every node can be handed out again in order
+			pool.reset();
+		}
+
+		//the closed set's nodes live in the pool, so it's declared first to be destroyed last
+		MemoryPool pool;
+
+		//a binary heap, managed with std::push_heap and std::pop_heap
+		std::vector<SearchItem<State>> openSet;
+
+		std::unordered_map<State, State, std::hash<State>, std::equal_to<State>, PoolAllocator<std::pair<const State, State>>> closedSet;
+
+		//the neighbors of the state being expanded. it's refilled for every expansion, so it stops growing after the first one
+		std::vector<std::pair<State, float>> neighbors;
+	};
+
+	//the functions are template parameters rather than std::functions, so they're inlined into the search loop
+	template<class State, class GoalFunction, class Observer, class NeighborFunction, class HeuristicFunction>
+	static std::vector<State> aStar(
+		const std::vector<State> &startStates,
+
+		//predicate that returns true if the given state is a goal state
+		GoalFunction goalFunction,
+
+		//told about each state as it's queued and expanded, see searchobservers.h
+		Observer &observer,
+
+		//called as neighborFunction(state, neighbors), and appends each neighbor of the state and the cost to move to it
+		//onto neighbors, which is empty when it's called
+		NeighborFunction neighborFunction,
+
+		//function to compute the heuristic for the given state
+		HeuristicFunction heuristicFunction
+		);
+
+	//same as above, but uses the given workspace for the open and closed sets, and for the neighbors
+	//if cancelled is given, the search stops as soon as it's set, and returns an empty path
+	template<class State, class GoalFunction, class Observer, class NeighborFunction, class HeuristicFunction>
+	static std::vector<State> aStar(
+		const std::vector<State> &startStates,
+		GoalFunction goalFunction,
+		Observer &observer,
+		NeighborFunction neighborFunction,
+		HeuristicFunction heuristicFunction,
+		Workspace<State> &workspace,
+		const std::atomic<bool> *cancelled
+		);
+
+private:
+	SearchAlgorithms() = default;
+};
+
+template<class State, class GoalFunction, class Observer, class NeighborFunction, class HeuristicFunction>
+std::vector<State> SearchAlgorithms::aStar(
+	const std::vector<State> &startStates,
+	GoalFunction goalFunction,
+	Observer &observer,
+	NeighborFunction neighborFunction,
+	HeuristicFunction heuristicFunction
+	)
+{
+	Workspace<State> workspace;
+	return aStar(startStates, goalFunction, observer, neighborFunction, heuristicFunction, workspace, nullptr);
+}
+
+template<class State, class GoalFunction, class Observer, class NeighborFunction, class HeuristicFunction>
+std::vector<State> SearchAlgorithms::aStar(
+	const std::vector<State> &startStates,
+	GoalFunction goalFunction,
+	Observer &observer,
+	NeighborFunction neighborFunction,
+	HeuristicFunction heuristicFunction,
+	Workspace<State> &workspace,
+	const std::atomic<bool> *cancelled
+	)
+{
+	//start from empty sets, but keep the memory the last search left behind
+	workspace.clear();
+
+	std::vector<SearchItem<State>> &openSet = workspace.openSet;
+	auto &closedSet = workspace.closedSet;
+	std::vector<std::pair<State, float>> &neighbors = workspace.neighbors;
+
+	//build the priority queue from the initial set of items
+	for (const auto& initialState : startStates)
+	{
+		openSet.emplace_back(initialState, initialState, 0.0f, heuristicFunction(initialState));
+		std::push_heap(openSet.begin(), openSet.end());
+		observer.onQueue(initialState, initialState);
+	}
+
+	State goalState;
+	bool foundGoal = false;
+
+	//each iteration is far too short to trace on its own, so they're traced in batches
+	TRACE_BATCH(expandTrace, "aStar expand batch", 4096);
+
+	//loop until we've gone though every node
+	while (!openSet.empty())
+	{
+		TRACE_BATCH_TICK(expandTrace);
+
+		if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+		{
+			return std::vector<State>();
+		}
+
+		std::pop_heap(openSet.begin(), openSet.end());
+		SearchItem<State> currentState = openSet.back();
+		openSet.pop_back();
+
+		//check if we've already hit this state
+		if (!closedSet.count(currentState.state))
+		{
+			closedSet[currentState.state] = currentState.parent;
+
+			//let the observer know this state is being processed
+			observer.onExpand(currentState.state, currentState.parent);
+
+			//if we've reached a goal state, end the loop
+			if (goalFunction(currentState.state))
+			{
+				foundGoal = true;
+				goalState = currentState.state;
+				break;
+			}
+
+			//loop through the neighbors of this state
+			neighbors.clear();
+			neighborFunction(currentState.state, neighbors);
+			for (const auto& neighbor : neighbors)
+			{
+				//"neighbor" is a 2-tuple, first item is the state and the second is the cost to move to that state
+
+				//if we haven't already viewed this neighbor
+				if (!closedSet.count(neighbor.first))
+				{
+					float totalCost = neighbor.second + currentState.currentCost;
+					float totalEstimatedCost = totalCost + heuristicFunction(neighbor.first);
+
+					openSet.emplace_back(neighbor.first, currentState.state, totalCost, totalEstimatedCost);
+					std::push_heap(openSet.begin(), openSet.end());
+					observer.onQueue(neighbor.first, currentState.state);
+				}
+			}
+		}
+	}
+
+	//we left the loop, see if we hit a goal state. if we didn't, the result vector will be empty
+	TRACE_SCOPE("aStar reconstruct path");
+	std::vector<State> result;
+	if (foundGoal)
+	{
+		State currentItem = goalState;
+		State currentParent = closedSet.at(goalState);
+
+		result.push_back(currentItem);
+
+		while (currentItem != currentParent)
+		{
+			currentItem = currentParent;
+			currentParent = closedSet.at(currentItem);
+
+			result.push_back(currentItem);
+		}
+	}
+	std::reverse(result.begin(), result.end());
+
+	return result;
+}
+
+
+#endif // SEARCHALGORITHMS_H
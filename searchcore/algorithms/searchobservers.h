@@ -0,0 +1,103 @@
+#ifndef SEARCHOBSERVERS_H
+#define SEARCHOBSERVERS_H
+
+#include <cstddef>
+
+//an observer is how SearchAlgorithms::aStar reports what it's doing. it's a template parameter instead of a std::function,
+//so its hooks are inlined into the search loop, and an observer whose hooks are empty costs nothing at all
+//every observer has the same two hooks:
+//	onExpand(state, parent) is called when a state comes off the open set and is expanded
+//	onQueue(state, parent) is called when a state is put on the open set. start states are their own parents
+
+//reports nothing, for searches where only the path matters
+struct NullSearchObserver
+{
+	template<class State> void onExpand(const State &, const State &) {}
+	template<class State> void onQueue(const State &, const State &) {}
+};
+
+//counts the expanded and queued states, and nothing else
+class CountingSearchObserver
+{
+public:
+	CountingSearchObserver(void)
+		:expandedCount(0), queuedCount(0)
+	{}
+
+	template<class State> void onExpand(const State &, const State &) { expandedCount++; }
+	template<class State> void onQueue(const State &, const State &) { queuedCount++; }
+
+	size_t getExpandedCount(void) const { return expandedCount; }
+	size_t getQueuedCount(void) const { return queuedCount; }
+
+private:
+	size_t expandedCount;
+	size_t queuedCount;
+};
+
+//counts every state, but only passes the first and then every nth expansion and every nth insertion on to another observer
+//for watching searches that are too big to report every state of. with an interval of 1, everything is passed on
+template<class Observer>
+class SampledSearchObserver : public CountingSearchObserver
+{
+public:
+	SampledSearchObserver(Observer &observer, size_t interval)
+		:observer(observer), interval(interval < 1 ? 1 : interval), expandCountdown(1), queueCountdown(1)
+	{}
+
+	template<class State>
+	void onExpand(const State &state, const State &parent)
+	{
+		CountingSearchObserver::onExpand(state, parent);
+		if (--expandCountdown == 0)
+		{
+			expandCountdown = interval;
+			observer.onExpand(state, parent);
+		}
+	}
+
+	template<class State>
+	void onQueue(const State &state, const State &parent)
+	{
+		CountingSearchObserver::onQueue(state, parent);
+		if (--queueCountdown == 0)
+		{
+			queueCountdown = interval;
+			observer.onQueue(state, parent);
+		}
+	}
+
+private:
+	Observer &observer;
+	const size_t interval;
+
+	//the number of events left until the next one is passed on
+	size_t expandCountdown;
+	size_t queueCountdown;
+};
+
+//passes every expansion and every insertion into the open set on to the given functions
+//they're usually lambdas, which get inlined too, so an empty one still costs nothing. see makeCallbackObserver
+template<class ExpandFunction, class QueueFunction>
+class CallbackSearchObserver
+{
+public:
+	CallbackSearchObserver(ExpandFunction expandFunction, QueueFunction queueFunction)
+		:expandFunction(expandFunction), queueFunction(queueFunction)
+	{}
+
+	template<class State> void onExpand(const State &state, const State &parent) { expandFunction(state, parent); }
+	template<class State> void onQueue(const State &state, const State &parent) { queueFunction(state, parent); }
+
+private:
+	ExpandFunction expandFunction;
+	QueueFunction queueFunction;
+};
+
+template<class ExpandFunction, class QueueFunction>
+CallbackSearchObserver<ExpandFunction, QueueFunction> makeCallbackObserver(ExpandFunction expandFunction, QueueFunction queueFunction)
+{
+	return CallbackSearchObserver<ExpandFunction, QueueFunction>(expandFunction, queueFunction);
+}
+
+#endif // SEARCHOBSERVERS_H
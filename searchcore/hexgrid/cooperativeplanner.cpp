@@ -0,0 +1,625 @@
+#include "cooperativeplanner.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <algorithm>
+
+#include "hexgrid/hexgrid.h"
+#include "utils/traceevents.h"
+
+CooperativePlanner::IndexTable::IndexTable(void)
+	:entries(16, Slot{ 0, 0, 0 }), generation(1), count(0), shift(60)
+{
+}
+
+void CooperativePlanner::IndexTable::clear(void)
+{
+	count = 0;
+	generation++;
+
+	//once the generation wraps around, the old stamps could look current again
+	if (generation == 0)
+	{
+		for (Slot &slot : entries)
+		{
+			slot.stamp = 0;
+		}
+		generation = 1;
+	}
+}
+
+size_t CooperativePlanner::IndexTable::findSlot(quint64 key) const
+{
+	//fibonacci hashing spreads keys that only differ in their low bits, like neighboring cells, across the whole table
+	size_t mask = entries.size() - 1;
+	size_t index = size_t((key * 0x9E3779B97F4A7C15ull) >> shift);
+	while (entries[index].stamp == generation && entries[index].key != key)
+	{
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+int CooperativePlanner::IndexTable::find(quint64 key) const
+{
+	const Slot &slot = entries[findSlot(key)];
+	return slot.stamp == generation ? slot.value : -1;
+}
+
+bool CooperativePlanner::IndexTable::insert(quint64 key, int value)
+{
+	int &slotValue = at(key);
+	if (slotValue >= 0)
+	{
+		return false;
+	}
+	slotValue = value;
+	return true;
+}
+
+int& CooperativePlanner::IndexTable::at(quint64 key)
+{
+	//keeping the table at most half full keeps the probes short
+	if ((count + 1) * 2 > entries.size())
+	{
+		grow();
+	}
+
+	Slot &slot = entries[findSlot(key)];
+	if (slot.stamp != generation)
+	{
+		slot.key = key;
+		slot.value = -1;
+		slot.stamp = generation;
+		count++;
+	}
+	return slot.value;
+}
+
+void CooperativePlanner::IndexTable::grow(void)
+{
+	std::vector<Slot> oldSlots(entries.size() * 2, Slot{ 0, 0, 0 });
+	oldSlots.swap(entries);
+
+	quint32 oldGeneration = generation;
+	generation = 1;
+	shift--;
+
+	for (const Slot &oldSlot : oldSlots)
+	{
+		if (oldSlot.stamp == oldGeneration)
+		{
+			entries[findSlot(oldSlot.key)] = Slot{ oldSlot.key, oldSlot.value, generation };
+		}
+	}
+}
+
+
+CooperativePlanner::CooperativePlanner(const HexGrid &grid, int window, int replanInterval, int stepLimit)
+	:width(grid.getWidth()), height(grid.getHeight()), topology(grid.getTopology()), window(qMax(1, window)),
+	replanInterval(replanInterval <= 0 ? qMax(1, window / 2) : qMin(replanInterval, qMax(1, window))),
+	stepLimit(stepLimit > 0 ? stepLimit : grid.getCellCount()),
+	unfinishedCount(0), stalledCount(0), expandedCount(0), roundCount(0)
+{
+	passable.resize(grid.getCellCount());
+	open.resize(grid.getCellCount());
+	for (const QPoint &cell : grid.getCells())
+	{
+		int index = grid.getIndex(cell);
+		passable[index] = grid.getPassableNeighbors(cell);
+		open[index] = grid.getEntry(cell).type != GridEntry::Wall;
+	}
+}
+
+bool CooperativePlanner::plan(const std::vector<Agent> &agents, std::vector<std::vector<QPoint>> &paths, QString &errorMessage)
+{
+	TRACE_SCOPE("CooperativePlanner::plan");
+
+	unfinishedCount = 0;
+	stalledCount = 0;
+	expandedCount = 0;
+	roundCount = 0;
+
+	std::vector<int> starts(agents.size()), goals(agents.size());
+	QHash<int, int> startOwners, goalOwners;
+	for (size_t i = 0; i < agents.size(); i++)
+	{
+		starts[i] = getCell(agents[i].start);
+		goals[i] = getCell(agents[i].goal);
+
+		if (starts[i] < 0 || !open[starts[i]])
+		{
+			errorMessage = QString("Agent %1 starts at %2,%3, which isn't an open cell").arg(i).arg(agents[i].start.x()).arg(agents[i].start.y());
+			return false;
+		}
+		if (goals[i] < 0 || !open[goals[i]])
+		{
+			errorMessage = QString("Agent %1 ends at %2,%3, which isn't an open cell").arg(i).arg(agents[i].goal.x()).arg(agents[i].goal.y());
+			return false;
+		}
+		if (startOwners.contains(starts[i]))
+		{
+			errorMessage = QString("Agents %1 and %2 start in the same cell").arg(startOwners.value(starts[i])).arg(i);
+			return false;
+		}
+		if (goalOwners.contains(goals[i]))
+		{
+			errorMessage = QString("Agents %1 and %2 end in the same cell").arg(goalOwners.value(goals[i])).arg(i);
+			return false;
+		}
+		startOwners.insert(starts[i], int(i));
+		goalOwners.insert(goals[i], int(i));
+	}
+
+	std::vector<int> targets(goals);
+	std::vector<std::vector<int>> cellPaths;
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		planAgents<Square4Topology>(starts, targets, cellPaths);
+		break;
+	case SQUARE8_TOPOLOGY:
+		planAgents<Square8Topology>(starts, targets, cellPaths);
+		break;
+	case HEX_TOPOLOGY:
+		planAgents<HexTopology>(starts, targets, cellPaths);
+		break;
+	}
+
+	paths.resize(agents.size());
+	for (size_t i = 0; i < agents.size(); i++)
+	{
+		//the agents keep planning until they're all done, so drop the steps spent waiting at the goal after getting there
+		std::vector<int> &cells = cellPaths[i];
+		while (cells.size() > 1 && cells.back() == targets[i] && cells[cells.size() - 2] == targets[i])
+		{
+			cells.pop_back();
+		}
+		if (cells.back() != goals[i])
+		{
+			unfinishedCount++;
+		}
+
+		paths[i].clear();
+		paths[i].reserve(cells.size());
+		for (int cell : cells)
+		{
+			paths[i].push_back(toPoint(cell));
+		}
+	}
+
+	//agents only wait where nobody before them planned to be, so the reservations rule out conflicts
+	Q_ASSERT(countConflicts(paths) == 0);
+	return true;
+}
+
+size_t CooperativePlanner::getUnfinishedCount(void) const
+{
+	return unfinishedCount;
+}
+
+size_t CooperativePlanner::getStalledCount(void) const
+{
+	return stalledCount;
+}
+
+size_t CooperativePlanner::getExpandedCount(void) const
+{
+	return expandedCount;
+}
+
+int CooperativePlanner::getRoundCount(void) const
+{
+	return roundCount;
+}
+
+size_t CooperativePlanner::countConflicts(const std::vector<std::vector<QPoint>> &paths)
+{
+	size_t stepCount = 0;
+	for (const std::vector<QPoint> &path : paths)
+	{
+		stepCount = qMax(stepCount, path.size());
+	}
+
+	//an agent whose path has ended stays in its last cell
+	auto getPosition = [&paths](size_t agent, size_t step)
+	{
+		const std::vector<QPoint> &path = paths[agent];
+		return path.empty() ? QPoint(-1, -1) : path[qMin(step, path.size() - 1)];
+	};
+
+	size_t conflicts = 0;
+	QHash<QPoint, int> occupants;
+	for (size_t step = 0; step < stepCount; step++)
+	{
+		occupants.clear();
+		for (size_t agent = 0; agent < paths.size(); agent++)
+		{
+			QPoint position = getPosition(agent, step);
+			if (occupants.contains(position))
+			{
+				conflicts++;
+			}
+			else
+			{
+				occupants.insert(position, int(agent));
+			}
+		}
+
+		//two agents that trade places pass through each other on the way
+		if (step > 0)
+		{
+			for (size_t agent = 0; agent < paths.size(); agent++)
+			{
+				QPoint position = getPosition(agent, step);
+				QPoint previous = getPosition(agent, step - 1);
+				int other = occupants.value(previous, -1);
+				if (position != previous && other > int(agent) && getPosition(other, step - 1) == position)
+				{
+					conflicts++;
+				}
+			}
+		}
+	}
+	return conflicts;
+}
+
+int CooperativePlanner::getCell(const QPoint &p) const
+{
+	if (p.y() < 0 || p.y() >= height)
+	{
+		return -1;
+	}
+
+	int rowStart = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(p.y()) : 0;
+	int column = p.x() - rowStart;
+	return column >= 0 && column < width ? p.y() * width + column : -1;
+}
+
+QPoint CooperativePlanner::toPoint(int cell) const
+{
+	int row = cell / width;
+	int rowStart = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(row) : 0;
+	return QPoint(cell % width + rowStart, row);
+}
+
+quint64 CooperativePlanner::getKey(int cell, int step)
+{
+	return (quint64(quint32(step)) << 32) | quint32(cell);
+}
+
+template<class Topology>
+int CooperativePlanner::getIndex(const QPoint &p) const
+{
+	return p.y() * width + p.x() - Topology::getRowStart(p.y());
+}
+
+template<class Topology>
+void CooperativePlanner::planAgents(const std::vector<int> &starts, std::vector<int> &targets, std::vector<std::vector<int>> &cellPaths)
+{
+	size_t agentCount = starts.size();
+
+	//each agent's search back from its target starts out with just the target, and is only run as far as it's asked about
+	if (trueDistances.size() < agentCount)
+	{
+		trueDistances.resize(agentCount);
+	}
+	auto resetTrueDistance = [this, &starts, &targets](size_t agent)
+	{
+		TrueDistance &distance = trueDistances[agent];
+		distance.origin = starts[agent];
+		distance.costs.clear();
+		distance.costs.at(targets[agent]) = 0;
+		distance.open.clear();
+
+		QPoint start = toPoint(starts[agent]), target = toPoint(targets[agent]);
+		distance.open.push_back({ Topology::getDistance(start.x() - target.x(), start.y() - target.y()), 0, targets[agent] });
+	};
+
+	for (size_t i = 0; i < agentCount; i++)
+	{
+		resetTrueDistance(i);
+		if (getTrueDistance<Topology>(trueDistances[i], starts[i]) >= UNREACHABLE)
+		{
+			targets[i] = starts[i];
+			resetTrueDistance(i);
+		}
+	}
+
+	cellPaths.assign(agentCount, std::vector<int>());
+	for (size_t i = 0; i < agentCount; i++)
+	{
+		cellPaths[i].push_back(starts[i]);
+	}
+
+	std::vector<int> positions(starts);
+	windowCells.resize(window + 1);
+
+	//agents plan in priority order, which starts out as the order they were given in
+	std::vector<int> order(agentCount);
+	for (size_t i = 0; i < agentCount; i++)
+	{
+		order[i] = int(i);
+	}
+	std::vector<int> roundCells(agentCount * replanInterval);
+
+	//a round only depends on where the agents are and the order they plan in when it starts. if both are ever back to how they
+	//were at the start of an earlier round, including when nobody moved and nobody was moved ahead, the agents would go round
+	//the same loop until the step limit. the starts are looked up by hash, and compared in full so a collision can't stop planning
+	std::vector<std::vector<int>> roundStarts;
+	QHash<quint64, QVector<int>> roundStartsByHash;
+
+	for (int firstStep = 0; firstStep < stepLimit; firstStep += replanInterval)
+	{
+		if (positions == targets)
+		{
+			break;
+		}
+
+		std::vector<int> roundStart(positions);
+		roundStart.insert(roundStart.end(), order.begin(), order.end());
+
+		quint64 hash = 14695981039346656037ull;
+		for (int value : roundStart)
+		{
+			hash = (hash ^ quint32(value)) * 1099511628211ull;
+		}
+
+		QVector<int> &sameHash = roundStartsByHash[hash];
+		bool repeated = false;
+		for (int round : sameHash)
+		{
+			repeated = repeated || roundStarts[round] == roundStart;
+		}
+		if (repeated)
+		{
+			break;
+		}
+		sameHash.append(int(roundStarts.size()));
+		roundStarts.push_back(roundStart);
+
+		roundCount++;
+
+		TRACE_SCOPE("CooperativePlanner round");
+
+		//an agent that gets stuck where waiting isn't safe either is moved to the front, and the round is planned again.
+		//after a few tries, every agent holds its cell for the whole round, so waiting is always safe, but nobody can make way
+		for (int attempt = 0; ; attempt++)
+		{
+			int holdSteps = attempt < PRIORITY_RETRIES ? 1 : replanInterval;
+			int blocked = planRound<Topology>(order, positions, targets, firstStep, holdSteps, roundCells);
+			if (blocked < 0)
+			{
+				break;
+			}
+			order.erase(std::find(order.begin(), order.end(), blocked));
+			order.insert(order.begin(), blocked);
+		}
+
+		for (size_t i = 0; i < agentCount; i++)
+		{
+			cellPaths[i].insert(cellPaths[i].end(), roundCells.begin() + i * replanInterval, roundCells.begin() + (i + 1) * replanInterval);
+			positions[i] = cellPaths[i].back();
+		}
+	}
+}
+
+template<class Topology>
+int CooperativePlanner::planRound(const std::vector<int> &order, const std::vector<int> &positions, const std::vector<int> &targets,
+	int firstStep, int holdSteps, std::vector<int> &roundCells)
+{
+	//every agent holds the cell it's in for the first few steps, until it plans to leave. agents after it in the order can still
+	//follow it into the cells it leaves, but agents before it can't walk in until the hold is over
+	reservations.clear();
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		for (int step = 0; step <= holdSteps; step++)
+		{
+			reservations.insert(getKey(positions[i], firstStep + step), int(i));
+		}
+	}
+
+	for (int agent : order)
+	{
+		int cell = positions[agent];
+		if (!planWindow<Topology>(agent, cell, targets[agent], firstStep))
+		{
+			stalledCount++;
+
+			//waiting is only safe if no agent before this one planned to walk into its cell during the steps that are carried out
+			for (int step = 1; step <= replanInterval; step++)
+			{
+				int holder = reservations.find(getKey(cell, firstStep + step));
+				if (holder >= 0 && holder != agent)
+				{
+					return agent;
+				}
+			}
+			std::fill(windowCells.begin(), windowCells.end(), cell);
+		}
+
+		for (int step = 1; step <= holdSteps; step++)
+		{
+			if (windowCells[step] != cell)
+			{
+				reservations.at(getKey(cell, firstStep + step)) = -1;
+			}
+		}
+
+		//a stalled agent's cells past the steps that are carried out may already be reserved, in which case the earlier agent
+		//keeps them. those steps are planned again next round, so they never end up in a path
+		for (int step = 1; step <= window; step++)
+		{
+			reservations.insert(getKey(windowCells[step], firstStep + step), agent);
+		}
+		std::copy(windowCells.begin() + 1, windowCells.begin() + replanInterval + 1, roundCells.begin() + size_t(agent) * replanInterval);
+	}
+	return -1;
+}
+
+template<class Topology>
+int CooperativePlanner::getTrueDistance(TrueDistance &distance, int cell)
+{
+	int known = distance.costs.find(cell);
+	if (known >= 0 && (known & 1) != 0)
+	{
+		return known >> 1;
+	}
+
+	QPoint origin = toPoint(distance.origin);
+	while (!distance.open.empty())
+	{
+		std::pop_heap(distance.open.begin(), distance.open.end());
+		OpenEntry entry = distance.open.back();
+		distance.open.pop_back();
+
+		//skip entries that were already expanded, or that a shorter way to the same cell has replaced
+		int &current = distance.costs.at(entry.index);
+		if ((current & 1) != 0 || (current >> 1) < entry.cost)
+		{
+			continue;
+		}
+		current = entry.cost * 2 + 1;
+
+		QPoint position = toPoint(entry.index);
+		quint8 moves = passable[entry.index];
+		for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+		{
+			if ((moves & (1 << direction)) == 0)
+			{
+				continue;
+			}
+
+			QPoint p = position + Topology::getNeighborOffset(direction);
+			int neighbor = getIndex<Topology>(p);
+			int cost = entry.cost + 1;
+			int &previous = distance.costs.at(neighbor);
+			if (previous < 0 || ((previous & 1) == 0 && (previous >> 1) > cost))
+			{
+				previous = cost * 2;
+				distance.open.push_back({ cost + Topology::getDistance(origin.x() - p.x(), origin.y() - p.y()), cost, neighbor });
+				std::push_heap(distance.open.begin(), distance.open.end());
+			}
+		}
+
+		if (entry.index == cell)
+		{
+			return entry.cost;
+		}
+	}
+	return UNREACHABLE;
+}
+
+template<class Topology>
+bool CooperativePlanner::planWindow(int agent, int cell, int goal, int firstStep)
+{
+	TrueDistance &distance = trueDistances[agent];
+
+	nodeIndices.clear();
+	nodes.clear();
+	openSet.clear();
+
+	nodes.push_back({ cell, 0, 0, -1, false });
+	nodeIndices.insert(getKey(cell, 0), 0);
+	openSet.push_back({ getTrueDistance<Topology>(distance, cell), 0, 0 });
+
+	int last = -1;
+	while (!openSet.empty())
+	{
+		std::pop_heap(openSet.begin(), openSet.end());
+		OpenEntry entry = openSet.back();
+		openSet.pop_back();
+
+		Node node = nodes[entry.index];
+		if (node.closed || node.cost < entry.cost)
+		{
+			continue;
+		}
+		nodes[entry.index].closed = true;
+		expandedCount++;
+
+		//the window is as far as this agent plans around the others. past it, the true distance is all that matters
+		if (node.step == window)
+		{
+			last = entry.index;
+			break;
+		}
+
+		int step = firstStep + node.step;
+		QPoint position = toPoint(node.cell);
+		quint8 moves = passable[node.cell];
+
+		//direction -1 is waiting where it is
+		for (int direction = -1; direction < Topology::NEIGHBOR_COUNT; direction++)
+		{
+			int next = node.cell;
+			if (direction >= 0)
+			{
+				if ((moves & (1 << direction)) == 0)
+				{
+					continue;
+				}
+				next = getIndex<Topology>(position + Topology::getNeighborOffset(direction));
+			}
+
+			//another agent has already planned to be there
+			int holder = reservations.find(getKey(next, step + 1));
+			if (holder >= 0 && holder != agent)
+			{
+				continue;
+			}
+
+			//the agent in the next cell is moving into this one, so they'd pass through each other
+			if (next != node.cell)
+			{
+				holder = reservations.find(getKey(next, step));
+				if (holder >= 0 && holder != agent && reservations.find(getKey(node.cell, step + 1)) == holder)
+				{
+					continue;
+				}
+			}
+
+			int estimate = getTrueDistance<Topology>(distance, next);
+			if (estimate >= UNREACHABLE)
+			{
+				continue;
+			}
+
+			//waiting at the goal is free, so an agent that's done stays there unless it has to make room
+			int cost = node.cost + (next == goal && node.cell == goal ? 0 : 1);
+
+			quint64 key = getKey(next, node.step + 1);
+			int index = nodeIndices.find(key);
+			if (index >= 0)
+			{
+				if (nodes[index].closed || nodes[index].cost <= cost)
+				{
+					continue;
+				}
+				nodes[index].cost = cost;
+				nodes[index].parent = entry.index;
+			}
+			else
+			{
+				index = int(nodes.size());
+				nodes.push_back({ next, node.step + 1, cost, entry.index, false });
+				nodeIndices.insert(key, index);
+			}
+
+			openSet.push_back({ cost + estimate, cost, index });
+			std::push_heap(openSet.begin(), openSet.end());
+		}
+	}
+
+	if (last < 0)
+	{
+		return false;
+	}
+
+	for (int index = last; index >= 0; index = nodes[index].parent)
+	{
+		windowCells[nodes[index].step] = nodes[index].cell;
+	}
+	return true;
+}
@@ -0,0 +1,182 @@
+#ifndef COOPERATIVEPLANNER_H
+#define COOPERATIVEPLANNER_H
+
+#include <QPoint>
+#include <QString>
+#include <QtGlobal>
+
+#include <vector>
+
+#include "hexgrid/gridtopology.h"
+
+class HexGrid;
+
+//plans paths for many agents at once, so that no two agents are in the same cell at the same step, or swap cells in one step
+//this is windowed hierarchical cooperative A*: the agents plan one at a time in priority order, and each one reserves the cells
+//it'll be in for the next few steps in a space-time reservation table, which the agents after it plan around
+//each agent only plans a window of steps around the others, and uses its true distance to its goal beyond the window.
+//the agents take half a window of steps, then every agent plans a new window from where it is. an agent that gets stuck
+//is moved ahead of the others, and every agent holds the cell it's in until it plans to leave, so a stuck agent can wait safely
+//the true distances come from a search back from the agent's goal, which is only run as far as the cells asked about so far,
+//and carries on from where it stopped the next time an agent asks for a cell it hasn't reached
+class CooperativePlanner
+{
+public:
+	//agents are given in their starting priority order. no two agents can start or end in the same cell
+	struct Agent
+	{
+		QPoint start;
+		QPoint goal;
+	};
+
+	//copies the walls out of the grid. later changes to the grid aren't seen
+	//with a replan interval of 0, agents take half a window of steps between plans
+	//with a step limit of 0, planning gives up after as many steps as the grid has cells
+	explicit CooperativePlanner(const HexGrid &grid, int window = 16, int replanInterval = 0, int stepLimit = 0);
+
+	//plans every agent. paths[i][t] is the cell agent i is in after t steps, starting at its start cell and ending at its goal,
+	//where it stays once the path ends. an agent that doesn't get to its goal ends wherever it was when planning stopped
+	//returns false if an agent starts or ends on a wall or outside the grid, or shares its start or goal with another agent
+	bool plan(const std::vector<Agent> &agents, std::vector<std::vector<QPoint>> &paths, QString &errorMessage);
+
+	//statistics about the last plan
+	//stalled windows are the ones where an agent couldn't find any moves that kept out of the other agents' way, so it stayed put
+	size_t getUnfinishedCount(void) const;
+	size_t getStalledCount(void) const;
+	size_t getExpandedCount(void) const;
+	int getRoundCount(void) const;
+
+	//counts the times two agents are in the same cell at the same step, or swap cells in one step. 0 for a plan that worked
+	static size_t countConflicts(const std::vector<std::vector<QPoint>> &paths);
+
+private:
+	//a hash table from 64 bit keys to non-negative ints, using open addressing so a lookup is usually one cache line
+	//clearing it is free, since every slot is stamped with the generation it was written in
+	class IndexTable
+	{
+	public:
+		IndexTable(void);
+
+		void clear(void);
+
+		//-1 if the key isn't in the table
+		int find(quint64 key) const;
+
+		//returns false, and leaves the table alone, if the key is already in the table
+		bool insert(quint64 key, int value);
+
+		//the value for the key, which is added with a value of -1 if it isn't in the table yet
+		//the reference is only good until the next key is added
+		int& at(quint64 key);
+
+	private:
+		//a slot is only in use if its stamp is the table's current generation
+		struct Slot
+		{
+			quint64 key;
+			int value;
+			quint32 stamp;
+		};
+
+		size_t findSlot(quint64 key) const;
+		void grow(void);
+
+		std::vector<Slot> entries;
+		quint32 generation;
+		size_t count;
+		int shift;
+	};
+
+	//both searches use their open sets as heaps, with the lowest estimate on top. ties go to the entry furthest along
+	struct OpenEntry
+	{
+		int estimate;
+		int cost;
+		int index;
+
+		bool operator<(const OpenEntry &other) const
+		{
+			return estimate > other.estimate || (estimate == other.estimate && cost < other.cost);
+		}
+	};
+
+	//the search back from one agent's goal. the costs table holds each cell's distance from the goal times 2, plus 1 once it's final
+	struct TrueDistance
+	{
+		int origin;
+		IndexTable costs;
+		std::vector<OpenEntry> open;
+	};
+
+	//a state of the windowed search: a cell, some number of steps into the window
+	struct Node
+	{
+		int cell;
+		int step;
+		int cost;
+		int parent;
+		bool closed;
+	};
+
+	//the distance used for cells that can't reach the goal at all
+	static const int UNREACHABLE = 1 << 29;
+
+	//how many times a round is planned again with a stuck agent moved to the front, before every agent holds its cell instead
+	static const int PRIORITY_RETRIES = 4;
+
+	//-1 if p isn't a valid cell
+	int getCell(const QPoint &p) const;
+	QPoint toPoint(int cell) const;
+
+	static quint64 getKey(int cell, int step);
+
+	//the same as getCell, for cells that are known to be valid
+	template<class Topology>
+	int getIndex(const QPoint &p) const;
+
+	//agents that can't reach their goal at all have their target changed to their start, so they still get out of the others' way
+	template<class Topology>
+	void planAgents(const std::vector<int> &starts, std::vector<int> &targets, std::vector<std::vector<int>> &cellPaths);
+
+	//plans one round for every agent in the given order, and puts the cells each agent is in for the steps that are carried out
+	//into roundCells, replanInterval per agent. every agent holds its cell for the first holdSteps steps of the round
+	//returns -1, or an agent that couldn't plan a window and couldn't safely wait either, in which case nothing is planned
+	template<class Topology>
+	int planRound(const std::vector<int> &order, const std::vector<int> &positions, const std::vector<int> &targets,
+		int firstStep, int holdSteps, std::vector<int> &roundCells);
+
+	template<class Topology>
+	int getTrueDistance(TrueDistance &distance, int cell);
+
+	//plans the given agent's next window starting at the given step, and fills windowCells with the cell it's in at each step of it
+	//returns false if every way through the window runs into a reservation
+	template<class Topology>
+	bool planWindow(int agent, int cell, int goal, int firstStep);
+
+	int width, height;
+	GridTopology topology;
+	const int window;
+	const int replanInterval;
+	int stepLimit;
+
+	//each cell's passable neighbor mask, and whether it's open, indexed the same way as HexGrid::getIndex
+	std::vector<quint8> passable;
+	std::vector<bool> open;
+
+	//which agent holds each cell at each step, keyed by getKey(cell, step)
+	IndexTable reservations;
+
+	//kept from one agent and one plan to the next, so planning stops allocating once it has seen its biggest window
+	std::vector<TrueDistance> trueDistances;
+	IndexTable nodeIndices;
+	std::vector<Node> nodes;
+	std::vector<OpenEntry> openSet;
+	std::vector<int> windowCells;
+
+	size_t unfinishedCount;
+	size_t stalledCount;
+	size_t expandedCount;
+	int roundCount;
+};
+
+#endif // COOPERATIVEPLANNER_H
@@ -0,0 +1,324 @@
+#ifndef GOALDISTANCE_H
+#define GOALDISTANCE_H
+
+#include <QPoint>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#include "hexgrid/gridtopology.h"
+
+//the vector versions of each topology's distance, see gridtopology.h. only the instruction set the build targets is compiled in
+template<class Topology>
+struct SimdDistance;
+
+#if defined(__AVX2__)
+template<>
+struct SimdDistance<HexTopology>
+{
+	static __m256i get(__m256i dx, __m256i dy)
+	{
+		return _mm256_max_epi32(_mm256_max_epi32(_mm256_abs_epi32(dx), _mm256_abs_epi32(dy)), _mm256_abs_epi32(_mm256_sub_epi32(dy, dx)));
+	}
+};
+
+template<>
+struct SimdDistance<Square4Topology>
+{
+	static __m256i get(__m256i dx, __m256i dy)
+	{
+		return _mm256_add_epi32(_mm256_abs_epi32(dx), _mm256_abs_epi32(dy));
+	}
+};
+
+template<>
+struct SimdDistance<Square8Topology>
+{
+	static __m256i get(__m256i dx, __m256i dy)
+	{
+		return _mm256_max_epi32(_mm256_abs_epi32(dx), _mm256_abs_epi32(dy));
+	}
+};
+#elif defined(__SSE4_1__)
+template<>
+struct SimdDistance<HexTopology>
+{
+	static __m128i get(__m128i dx, __m128i dy)
+	{
+		return _mm_max_epi32(_mm_max_epi32(_mm_abs_epi32(dx), _mm_abs_epi32(dy)), _mm_abs_epi32(_mm_sub_epi32(dy, dx)));
+	}
+};
+
+template<>
+struct SimdDistance<Square4Topology>
+{
+	static __m128i get(__m128i dx, __m128i dy)
+	{
+		return _mm_add_epi32(_mm_abs_epi32(dx), _mm_abs_epi32(dy));
+	}
+};
+
+template<>
+struct SimdDistance<Square8Topology>
+{
+	static __m128i get(__m128i dx, __m128i dy)
+	{
+		return _mm_max_epi32(_mm_abs_epi32(dx), _mm_abs_epi32(dy));
+	}
+};
+#endif
+
+//finds how far a cell is from the closest of a set of goals, for the A* heuristic
+//the goals are kept as separate x and y arrays, so 8 goals are compared at once with AVX2, or 4 with SSE4.1,
+//when the build targets them (CONFIG+=simd). otherwise the loop has no branches, so the compiler can vectorize it itself
+//big goal sets are sorted into a grid of square buckets. the buckets are visited in rings around the cell, and the search stops
+//once a ring is further away than the closest goal so far, so a query only looks at the few buckets near its closest goal
+template<class Topology>
+class GoalDistance
+{
+public:
+	explicit GoalDistance(const std::vector<QPoint> &goals);
+
+	//INT_MAX if there are no goals
+	int getDistance(const QPoint &p) const;
+
+	//the number of buckets the goals were sorted into, for diagnostics
+	size_t getBucketCount(void) const;
+
+private:
+	//every bucket holds a multiple of this many goals, padded with copies of its last goal
+	static const size_t LANES = 8;
+
+	//fewer goals than this are kept in a single bucket, since scanning them is cheaper than walking the rings
+	static const size_t BUCKETING_THRESHOLD = 64;
+
+	//about how many goals each bucket should hold, if the goals are spread evenly
+	static const int GOALS_PER_BUCKET = 16;
+
+	struct Bucket
+	{
+		int minX, minY, maxX, maxY;
+		size_t first, count;
+	};
+
+	//no goal in the bucket can be closer than this. every topology's distance is at least as big as the larger of |dx| and |dy|
+	static int getLowerBound(const Bucket &bucket, int x, int y);
+
+	//the smaller of 'best' and the distance to the closest goal in [first, first + count)
+	int scan(size_t first, size_t count, int x, int y, int best) const;
+
+	//scans the bucket at the given column and row, unless it's off the bucket grid or too far away to matter
+	int scanBucket(int column, int row, int x, int y, int best) const;
+
+	std::vector<std::int32_t> xs;
+	std::vector<std::int32_t> ys;
+
+	//the buckets are stored row by row. bucket (column, row) covers the cells from
+	//(originX + column * side, originY + row * side) up to but not including the next bucket
+	std::vector<Bucket> buckets;
+	int originX, originY;
+	int side;
+	int columns, rows;
+};
+
+template<class Topology>
+GoalDistance<Topology>::GoalDistance(const std::vector<QPoint> &goals)
+	:originX(0), originY(0), side(1), columns(1), rows(1)
+{
+	if (goals.empty())
+	{
+		return;
+	}
+
+	int maxX = INT_MIN, maxY = INT_MIN;
+	originX = originY = INT_MAX;
+	for (const QPoint &goal : goals)
+	{
+		originX = std::min(originX, goal.x());
+		originY = std::min(originY, goal.y());
+		maxX = std::max(maxX, goal.x());
+		maxY = std::max(maxY, goal.y());
+	}
+
+	//a single bucket big enough to hold every goal
+	side = std::max(maxX - originX, maxY - originY) + 1;
+
+	if (goals.size() >= BUCKETING_THRESHOLD)
+	{
+		double area = double(maxX - originX + 1) * double(maxY - originY + 1);
+		side = std::max(1, int(std::ceil(std::sqrt(area * GOALS_PER_BUCKET / goals.size()))));
+	}
+	columns = (maxX - originX) / side + 1;
+	rows = (maxY - originY) / side + 1;
+
+	//count the goals in each bucket, then lay them out bucket by bucket
+	std::vector<std::vector<QPoint>> bucketGoals(size_t(columns) * size_t(rows));
+	for (const QPoint &goal : goals)
+	{
+		bucketGoals[size_t((goal.y() - originY) / side) * columns + (goal.x() - originX) / side].push_back(goal);
+	}
+
+	buckets.resize(bucketGoals.size());
+	for (size_t i = 0; i < bucketGoals.size(); i++)
+	{
+		Bucket &bucket = buckets[i];
+		bucket.minX = bucket.minY = INT_MAX;
+		bucket.maxX = bucket.maxY = INT_MIN;
+		bucket.first = xs.size();
+
+		for (const QPoint &goal : bucketGoals[i])
+		{
+			xs.push_back(goal.x());
+			ys.push_back(goal.y());
+
+			bucket.minX = std::min(bucket.minX, goal.x());
+			bucket.minY = std::min(bucket.minY, goal.y());
+			bucket.maxX = std::max(bucket.maxX, goal.x());
+			bucket.maxY = std::max(bucket.maxY, goal.y());
+		}
+
+		//repeating a goal doesn't change the minimum, and it means the scan never needs a scalar tail
+		while ((xs.size() - bucket.first) % LANES != 0)
+		{
+			xs.push_back(xs.back());
+			ys.push_back(ys.back());
+		}
+		bucket.count = xs.size() - bucket.first;
+	}
+}
+
+template<class Topology>
+int GoalDistance<Topology>::getDistance(const QPoint &p) const
+{
+	if (buckets.empty())
+	{
+		return INT_MAX;
+	}
+
+	int x = p.x(), y = p.y();
+	if (buckets.size() == 1)
+	{
+		return scan(0, xs.size(), x, y, INT_MAX);
+	}
+
+	//the bucket the cell is in, or the nearest one if it's outside the goals' bounding box
+	int centerColumn = std::min(std::max(0, int(std::floor(double(x - originX) / side))), columns - 1);
+	int centerRow = std::min(std::max(0, int(std::floor(double(y - originY) / side))), rows - 1);
+
+	int best = INT_MAX;
+	int ringCount = std::max(columns, rows);
+	for (int ring = 0; ring < ringCount; ring++)
+	{
+		//every bucket in this ring is at least ring - 1 whole buckets away along x or y
+		if (ring > 0 && (ring - 1) * side >= best)
+		{
+			break;
+		}
+
+		if (ring == 0)
+		{
+			best = scanBucket(centerColumn, centerRow, x, y, best);
+			continue;
+		}
+
+		for (int column = centerColumn - ring; column <= centerColumn + ring; column++)
+		{
+			best = scanBucket(column, centerRow - ring, x, y, best);
+			best = scanBucket(column, centerRow + ring, x, y, best);
+		}
+		for (int row = centerRow - ring + 1; row < centerRow + ring; row++)
+		{
+			best = scanBucket(centerColumn - ring, row, x, y, best);
+			best = scanBucket(centerColumn + ring, row, x, y, best);
+		}
+	}
+	return best;
+}
+
+template<class Topology>
+size_t GoalDistance<Topology>::getBucketCount(void) const
+{
+	return buckets.size();
+}
+
+template<class Topology>
+int GoalDistance<Topology>::scanBucket(int column, int row, int x, int y, int best) const
+{
+	if (column < 0 || column >= columns || row < 0 || row >= rows)
+	{
+		return best;
+	}
+
+	const Bucket &bucket = buckets[size_t(row) * columns + column];
+	if (bucket.count == 0 || getLowerBound(bucket, x, y) >= best)
+	{
+		return best;
+	}
+	return scan(bucket.first, bucket.count, x, y, best);
+}
+
+template<class Topology>
+int GoalDistance<Topology>::getLowerBound(const Bucket &bucket, int x, int y)
+{
+	int dx = std::max(0, std::max(bucket.minX - x, x - bucket.maxX));
+	int dy = std::max(0, std::max(bucket.minY - y, y - bucket.maxY));
+	return std::max(dx, dy);
+}
+
+template<class Topology>
+int GoalDistance<Topology>::scan(size_t first, size_t count, int x, int y, int best) const
+{
+	const std::int32_t *goalXs = xs.data() + first;
+	const std::int32_t *goalYs = ys.data() + first;
+
+#if defined(__AVX2__)
+	__m256i px = _mm256_set1_epi32(x);
+	__m256i py = _mm256_set1_epi32(y);
+	__m256i minimum = _mm256_set1_epi32(best);
+
+	for (size_t i = 0; i < count; i += 8)
+	{
+		__m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(goalXs + i)), px);
+		__m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(goalYs + i)), py);
+		minimum = _mm256_min_epi32(minimum, SimdDistance<Topology>::get(dx, dy));
+	}
+
+	//fold the 8 lanes down to 1
+	__m128i folded = _mm_min_epi32(_mm256_castsi256_si128(minimum), _mm256_extracti128_si256(minimum, 1));
+	folded = _mm_min_epi32(folded, _mm_shuffle_epi32(folded, _MM_SHUFFLE(1, 0, 3, 2)));
+	folded = _mm_min_epi32(folded, _mm_shuffle_epi32(folded, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(folded);
+#elif defined(__SSE4_1__)
+	__m128i px = _mm_set1_epi32(x);
+	__m128i py = _mm_set1_epi32(y);
+	__m128i minimum = _mm_set1_epi32(best);
+
+	for (size_t i = 0; i < count; i += 4)
+	{
+		__m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(goalXs + i)), px);
+		__m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(goalYs + i)), py);
+		minimum = _mm_min_epi32(minimum, SimdDistance<Topology>::get(dx, dy));
+	}
+
+	minimum = _mm_min_epi32(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+	minimum = _mm_min_epi32(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(minimum);
+#else
+	for (size_t i = 0; i < count; i++)
+	{
+		best = std::min(best, Topology::getDistance(goalXs[i] - x, goalYs[i] - y));
+	}
+	return best;
+#endif
+}
+
+#endif // GOALDISTANCE_H
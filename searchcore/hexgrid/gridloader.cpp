@@ -0,0 +1,75 @@
+#include "gridloader.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+#include "hexgrid/hexgrid.h"
+
+std::unique_ptr<HexGrid> GridLoader::load(const QString &fileName, QString &errorMessage)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(fileName, file.errorString());
+		return nullptr;
+	}
+
+	QTextStream stream(&file);
+
+	//the header is the width followed by the height, and optionally the topology
+	QStringList header = stream.readLine().split(' ', QString::SkipEmptyParts);
+
+	bool widthOk = false, heightOk = false;
+	int width = header.value(0).toInt(&widthOk);
+	int height = header.value(1).toInt(&heightOk);
+	if (header.size() < 2 || header.size() > 3 || !widthOk || !heightOk || width <= 0 || height <= 0)
+	{
+		errorMessage = QString("%1: expected \"width height\" on the first line").arg(fileName);
+		return nullptr;
+	}
+
+	GridTopology topology = HEX_TOPOLOGY;
+	if (header.size() == 3 && !HexGrid::parseTopology(header[2], topology))
+	{
+		errorMessage = QString("%1: unknown topology \"%2\"").arg(fileName, header[2]);
+		return nullptr;
+	}
+
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height, topology));
+
+	for (int i = 0; i < height; i++)
+	{
+		QString line = stream.readLine();
+		if (line.size() < width)
+		{
+			errorMessage = QString("%1: row %2 is shorter than the grid width").arg(fileName).arg(i);
+			return nullptr;
+		}
+
+		for (int j = 0; j < width; j++)
+		{
+			QPoint cell = grid->toCell(j, i);
+
+			switch (line.at(j).toLatin1())
+			{
+			case '.':
+				break;
+			case '#':
+				grid->setType(cell, GridEntry::Wall);
+				break;
+			case 'S':
+				grid->setType(cell, GridEntry::Start);
+				break;
+			case 'G':
+				grid->setType(cell, GridEntry::End);
+				break;
+			default:
+				errorMessage = QString("%1: unknown cell '%2' in row %3").arg(fileName, line.at(j)).arg(i);
+				return nullptr;
+			}
+		}
+	}
+
+	return grid;
+}
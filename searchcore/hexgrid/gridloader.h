@@ -0,0 +1,22 @@
+#ifndef GRIDLOADER_H
+#define GRIDLOADER_H
+
+#include <QString>
+#include <memory>
+
+class HexGrid;
+
+class GridLoader
+{
+public:
+	//loads a grid from a text file. the first line holds the width and height of the grid, followed by one line per row
+	//the first line can also name the grid's topology after the height: hex, square4 or square8. grids are hex by default
+	//in each row, '.' is an open cell, '#' is a wall, 'S' is a start cell and 'G' is a goal cell
+	//returns nullptr and sets errorMessage if the file couldn't be loaded
+	static std::unique_ptr<HexGrid> load(const QString &fileName, QString &errorMessage);
+
+private:
+	GridLoader() = default;
+};
+
+#endif // GRIDLOADER_H
@@ -0,0 +1,293 @@
+#include "gridsearcher.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "hexgrid/goaldistance.h"
+#include "hexgrid/hexgrid.h"
+#include "utils/spscchannel.h"
+#include "utils/traceevents.h"
+#include "algorithms/searchalgorithms.h"
+
+//define a hash function for QPoint
+namespace std {
+	template <> struct hash < QPoint >
+	{
+		size_t operator()(const QPoint &point) const
+		{
+			int hashSize = sizeof(size_t);
+
+			size_t a = std::hash<int>()(point.x());
+			size_t b = std::hash<int>()(point.y());
+
+			size_t c = (b << (hashSize / 2)) | (b >> (hashSize / 2));
+
+			return a ^ c;
+		}
+	};
+}
+
+struct GridSearcher::Workspace::Data
+{
+	SearchAlgorithms::Workspace<QPoint> searchWorkspace;
+};
+
+GridSearcher::Workspace::Workspace(void)
+	:data(new Data())
+{
+}
+
+GridSearcher::Workspace::~Workspace(void)
+{
+}
+
+
+GridSearcher::GridSearcher(const HexGrid &grid, Engine engine, Detail detail, size_t sampleInterval) :
+	grid(grid), engine(engine), detail(detail), sampleInterval(sampleInterval)
+{
+}
+
+QString GridSearcher::getEngineName(Engine engine)
+{
+	return engine == ASTAR ? "astar" : "dijkstra";
+}
+
+void GridSearcher::findEndpoints(const HexGrid &grid, std::vector<QPoint> &startStates, std::vector<QPoint> &goalStates)
+{
+	//find all end states and start states in the grid
+	for (const auto& cell : grid.getCells())
+	{
+		const GridEntry& entry = grid.getEntry(cell);
+
+		if (entry.type == GridEntry::Start)
+		{
+			startStates.push_back(cell);
+		}
+		else if (entry.type == GridEntry::End)
+		{
+			goalStates.push_back(cell);
+		}
+	}
+}
+
+void GridSearcher::search(std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel)
+{
+	std::vector<QPoint> startStates;
+	std::vector<QPoint> goalStates;
+	findEndpoints(grid, startStates, goalStates);
+
+	search(startStates, goalStates, outputChannel);
+}
+
+void GridSearcher::search(const std::vector<QPoint> &startStates, const std::vector<QPoint> &goalStates, std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel) const
+{
+	Workspace workspace;
+	search(startStates, goalStates, outputChannel, workspace, CancellationToken());
+}
+
+std::vector<QPoint> GridSearcher::search(
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalStates,
+	std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel,
+	Workspace &workspace,
+	CancellationToken token,
+	size_t *expandedStates,
+	std::atomic<size_t> *expandedProgress
+	) const
+{
+	TRACE_SCOPE("GridSearcher::search");
+
+	size_t expanded = 0;
+
+	//the open set insertions are only reported when asked for, so the usual search doesn't even check whether to report them
+	std::vector<QPoint> result = detail == OPEN_SET
+		? runReportedSearch<true>(startStates, goalStates, outputChannel, workspace, token, expanded, expandedProgress)
+		: runReportedSearch<false>(startStates, goalStates, outputChannel, workspace, token, expanded, expandedProgress);
+
+	//close the output channel to wrap things up
+	outputChannel->closeBack();
+
+	if (expandedStates != nullptr)
+	{
+		*expandedStates = expanded;
+	}
+	return result;
+}
+
+std::vector<QPoint> GridSearcher::findPath(const std::vector<QPoint> &startStates, const std::vector<QPoint> &goalStates, size_t *expandedStates) const
+{
+	Workspace workspace;
+	return findPath(startStates, goalStates, workspace, CancellationToken(), expandedStates);
+}
+
+std::vector<QPoint> GridSearcher::findPath(
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalStates,
+	Workspace &workspace,
+	const CancellationToken &token,
+	size_t *expandedStates
+	) const
+{
+	//if nobody wants the count, the search is compiled with no observer at all
+	if (expandedStates == nullptr)
+	{
+		NullSearchObserver observer;
+		return runSearch(startStates, goalStates, observer, workspace, token);
+	}
+
+	CountingSearchObserver observer;
+	std::vector<QPoint> result = runSearch(startStates, goalStates, observer, workspace, token);
+	*expandedStates = observer.getExpandedCount();
+	return result;
+}
+
+template<bool reportQueue>
+std::vector<QPoint> GridSearcher::runReportedSearch(
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalStates,
+	std::shared_ptr<SpscChannel<GridSearchEvent>> &outputChannel,
+	Workspace &workspace,
+	CancellationToken &token,
+	size_t &expanded,
+	std::atomic<size_t> *expandedProgress
+	) const
+{
+	//events are handed to the channel in batches, so the cost of waking up the consumer is paid once per batch
+	std::vector<GridSearchEvent> pendingEvents;
+	pendingEvents.reserve(EVENT_BATCH_SIZE);
+
+	//the observer below does the counting. it's set once the observer exists
+	const CountingSearchObserver *counter = nullptr;
+
+	//if nobody is reading the channel anymore, there's no point in finishing the search
+	auto flushEvents = [&outputChannel, &pendingEvents, &token, &counter, expandedProgress]()
+	{
+		TRACE_SCOPE("GridSearcher flush events");
+		if (expandedProgress != nullptr && counter != nullptr)
+		{
+			expandedProgress->store(counter->getExpandedCount(), std::memory_order_relaxed);
+		}
+		if (!outputChannel->pushMany(std::make_move_iterator(pendingEvents.begin()), std::make_move_iterator(pendingEvents.end())))
+		{
+			token.cancel();
+		}
+		pendingEvents.clear();
+	};
+
+	auto addEvent = [&pendingEvents, &flushEvents](GridSearchEvent::EventType type, const QPoint &state)
+	{
+		pendingEvents.emplace_back(type, state);
+		if (pendingEvents.size() >= EVENT_BATCH_SIZE)
+		{
+			flushEvents();
+		}
+	};
+
+	auto reporter = makeCallbackObserver(
+		[&addEvent](const QPoint &currentState, const QPoint &) { addEvent(GridSearchEvent::EXPAND, currentState); },
+		[&addEvent](const QPoint &currentState, const QPoint &)
+		{
+			if (reportQueue)
+			{
+				addEvent(GridSearchEvent::NEIGHBOR, currentState);
+			}
+		});
+	SampledSearchObserver<decltype(reporter)> observer(reporter, sampleInterval);
+	counter = &observer;
+
+	//perform the search
+	std::vector<QPoint> result = runSearch(startStates, goalStates, observer, workspace, token);
+	expanded = observer.getExpandedCount();
+	if (expandedProgress != nullptr)
+	{
+		expandedProgress->store(expanded, std::memory_order_relaxed);
+	}
+
+	//put out a search event for each item in the final route, in reversed order, to simulate backtracing the result
+	for (auto item = result.rbegin(); item != result.rend(); ++item)
+	{
+		pendingEvents.emplace_back(GridSearchEvent::BACKTRACE, *item);
+	}
+	if (!token.isCancelled())
+	{
+		flushEvents();
+	}
+	return result;
+}
+
+template<class Observer>
+std::vector<QPoint> GridSearcher::runSearch(
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalStates,
+	Observer &observer,
+	Workspace &workspace,
+	const CancellationToken &token
+	) const
+{
+	switch (grid.getTopology())
+	{
+	case SQUARE4_TOPOLOGY:
+		return runSearch<Square4Topology>(startStates, goalStates, observer, workspace, token);
+	case SQUARE8_TOPOLOGY:
+		return runSearch<Square8Topology>(startStates, goalStates, observer, workspace, token);
+	default:
+		return runSearch<HexTopology>(startStates, goalStates, observer, workspace, token);
+	}
+}
+
+template<class Topology, class Observer>
+std::vector<QPoint> GridSearcher::runSearch(
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalVector,
+	Observer &observer,
+	Workspace &workspace,
+	const CancellationToken &token
+	) const
+{
+	//without a start and a goal there is nothing to search for, and the heuristic below needs at least one goal
+	if (startStates.empty() || goalVector.empty())
+	{
+		return std::vector<QPoint>();
+	}
+
+	TRACE_SCOPE("GridSearcher::runSearch");
+
+	std::unordered_set<QPoint> goalStates(goalVector.begin(), goalVector.end());
+
+	//define a function that returns true if the given state is a goal state
+	auto goalFunction = [&goalStates](const QPoint &currentState)
+	{
+		return bool(goalStates.count(currentState));
+	};
+
+	//define a function that adds the neighbors and associated costs for the given state into the workspace's neighbor buffer
+	auto neighborFunction = [this](const QPoint &currentState, std::vector<std::pair<QPoint, float>> &neighbors)
+	{
+		//the grid keeps a mask of which neighbors can be walked to, so we don't have to look at the neighbors themselves
+		quint8 passable = grid.getPassableNeighbors(currentState);
+		for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+		{
+			if (passable & (1 << direction))
+			{
+				neighbors.emplace_back(currentState + Topology::getNeighborOffset(direction), 1.0f);
+			}
+		}
+	};
+
+	//define a function that returns the heuristic for the given state
+	//the goals are laid out once per search so that each call compares many of them at once, see GoalDistance
+	GoalDistance<Topology> goalDistance(engine == DIJKSTRA ? std::vector<QPoint>() : goalVector);
+	auto heuristicFunction = [this, &goalDistance](const QPoint &currentState)
+	{
+		if (engine == DIJKSTRA)
+		{
+			return 0.0f;
+		}
+
+		return float(goalDistance.getDistance(currentState));
+	};
+
+	//perform the search
+	return SearchAlgorithms::aStar<QPoint>(startStates, goalFunction, observer, neighborFunction, heuristicFunction,
+		workspace.data->searchWorkspace, token.getFlag());
+}
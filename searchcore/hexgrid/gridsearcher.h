@@ -0,0 +1,132 @@
+#ifndef GRIDSEARCHER_H
+#define GRIDSEARCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QSet>
+#include <QPoint>
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <functional>
+
+#include "hexgrid/gridsearchevent.h"
+#include "utils/spscchannel.h"
+#include "utils/cancellationtoken.h"
+
+class HexGrid;
+
+
+class GridSearcher
+{
+public:
+	//ASTAR uses the grid's distance to the closest goal as its heuristic, DIJKSTRA uses no heuristic at all
+	enum Engine { ASTAR, DIJKSTRA };
+
+	//how much of the search is put into the channel. EXPANSIONS reports each expanded cell, OPEN_SET also reports each cell
+	//as it's added to the open set, as a NEIGHBOR event. searches that don't report to a channel don't pay for either
+	enum Detail { EXPANSIONS, OPEN_SET };
+
+	//memory for the open and closed sets that's kept from one search to the next, so a thread that runs many searches
+	//stops allocating for them once it has seen its biggest one. only one search may use a workspace at a time
+	class Workspace
+	{
+	public:
+		Workspace(void);
+		~Workspace(void);
+
+	private:
+		friend class GridSearcher;
+
+		struct Data;
+		std::unique_ptr<Data> data;
+	};
+
+	//with a sample interval above 1, only the first and then every nth expansion (and every nth open set insertion) is reported,
+	//for watching searches too big to show every cell of. the path is always reported in full
+	explicit GridSearcher(const HexGrid &grid, Engine engine = ASTAR, Detail detail = EXPANSIONS, size_t sampleInterval = 1);
+
+	//the name used for the engine on the command line and in the comparison view
+	static QString getEngineName(Engine engine);
+
+	//find every start cell and every goal cell in the grid
+	static void findEndpoints(const HexGrid &grid, std::vector<QPoint> &startStates, std::vector<QPoint> &goalStates);
+
+	//search from the grid's start cells to its goal cells, putting each expanded cell and then the resulting path into the channel
+	void search(std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel);
+
+	//same as above, but between the given cells instead of the grid's start and goal cells. safe to call from several threads at once
+	void search(const std::vector<QPoint> &startStates, const std::vector<QPoint> &goalStates, std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel) const;
+
+	//same as above, but using the given workspace, and also returning the path like findPath does
+	//the search stops early if the token is cancelled, or if the front of the channel is closed, which cancels the token too
+	//if it stops early, no path is reported or returned. the back of the channel is closed either way
+	//if expandedProgress is given, the number of states expanded so far is stored into it with every batch of events,
+	//so another thread can watch how fast the search itself is going, even while the channel is backed up
+	std::vector<QPoint> search(
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel,
+		Workspace &workspace,
+		CancellationToken token,
+		size_t *expandedStates = nullptr,
+		std::atomic<size_t> *expandedProgress = nullptr
+		) const;
+
+	//search from the given start cells to the given goal cells without reporting any progress. safe to call from several threads at once
+	//returns the path from start to goal, or an empty vector if there is no path. if expandedStates is given, it's set to the number of states expanded
+	std::vector<QPoint> findPath(const std::vector<QPoint> &startStates, const std::vector<QPoint> &goalStates, size_t *expandedStates = nullptr) const;
+
+	//same as above, but using the given workspace. returns an empty path if the token is cancelled before the search finishes
+	std::vector<QPoint> findPath(
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		Workspace &workspace,
+		const CancellationToken &token,
+		size_t *expandedStates = nullptr
+		) const;
+
+private:
+	//how many events the search thread collects before handing them to the output channel
+	static const size_t EVENT_BATCH_SIZE = 16;
+
+	//picks the version of the search compiled for the grid's topology. the observer is a template parameter
+	//so that searches which don't report anything compile without any reporting code, see searchobservers.h
+	template<class Observer>
+	std::vector<QPoint> runSearch(
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		Observer &observer,
+		Workspace &workspace,
+		const CancellationToken &token
+		) const;
+
+	template<class Topology, class Observer>
+	std::vector<QPoint> runSearch(
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		Observer &observer,
+		Workspace &workspace,
+		const CancellationToken &token
+		) const;
+
+	//reports every expansion, and every open set insertion if reportQueue is true, into the channel
+	template<bool reportQueue>
+	std::vector<QPoint> runReportedSearch(
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		std::shared_ptr<SpscChannel<GridSearchEvent>> &outputChannel,
+		Workspace &workspace,
+		CancellationToken &token,
+		size_t &expanded,
+		std::atomic<size_t> *expandedProgress
+		) const;
+
+	const HexGrid &grid;
+	const Engine engine;
+	const Detail detail;
+	const size_t sampleInterval;
+};
+
+#endif // GRIDSEARCHER_H
@@ -5,6 +5,7 @@
 
 struct GridSearchEvent
 {
+	//NEIGHBOR is a cell being added to the open set, which is only reported by searchers asked for GridSearcher::OPEN_SET
 	enum EventType { NEIGHBOR, EXPAND, BACKTRACE } eventType;
 	QPoint point;
 
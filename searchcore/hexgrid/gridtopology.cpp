@@ -0,0 +1,6 @@
+#include "gridtopology.h"
+
+//the tables are indexed with directions that are only known at run time, so they need a definition as well as a declaration
+constexpr int HexTopology::OFFSETS[HexTopology::NEIGHBOR_COUNT][2];
+constexpr int Square4Topology::OFFSETS[Square4Topology::NEIGHBOR_COUNT][2];
+constexpr int Square8Topology::OFFSETS[Square8Topology::NEIGHBOR_COUNT][2];
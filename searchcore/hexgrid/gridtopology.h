@@ -0,0 +1,62 @@
+#ifndef GRIDTOPOLOGY_H
+#define GRIDTOPOLOGY_H
+
+#include <QPoint>
+
+//the shapes of cell a grid can be made of. a grid's topology is picked when it's created or loaded, and never changes
+enum GridTopology { HEX_TOPOLOGY, SQUARE4_TOPOLOGY, SQUARE8_TOPOLOGY };
+
+//each topology is a type with its moves and distance in constexpr tables, so code that's templated on the topology
+//has its neighbor loops unrolled and its offsets folded in. direction i and (i + NEIGHBOR_COUNT / 2) % NEIGHBOR_COUNT are opposites
+//every move costs 1, so the distance is the number of moves between two cells on an empty grid
+struct TopologyMath
+{
+	static constexpr int absolute(int value) { return value < 0 ? -value : value; }
+	static constexpr int maximum(int a, int b) { return a < b ? b : a; }
+};
+
+//hex cells, stored in skewed rows: the y axis is at a 60 degree angle to the x axis, so each row starts half a column further right
+//than the row above it. see HexGrid
+struct HexTopology : TopologyMath
+{
+	static const GridTopology TOPOLOGY = HEX_TOPOLOGY;
+	static const int NEIGHBOR_COUNT = 6;
+	static constexpr int OFFSETS[NEIGHBOR_COUNT][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 0, -1 }, { -1, 0 }, { -1, -1 } };
+
+	static constexpr QPoint getNeighborOffset(int direction) { return QPoint(OFFSETS[direction][0], OFFSETS[direction][1]); }
+	static constexpr int getOppositeDirection(int direction) { return (direction + NEIGHBOR_COUNT / 2) % NEIGHBOR_COUNT; }
+
+	//the x coordinate of the first cell in the given row
+	static constexpr int getRowStart(int row) { return row / 2; }
+
+	//the third cube axis is y - x, and every move steps along two of the three axes
+	static constexpr int getDistance(int dx, int dy) { return maximum(maximum(absolute(dx), absolute(dy)), absolute(dy - dx)); }
+};
+
+//square cells that can only move straight up, down, left or right
+struct Square4Topology : TopologyMath
+{
+	static const GridTopology TOPOLOGY = SQUARE4_TOPOLOGY;
+	static const int NEIGHBOR_COUNT = 4;
+	static constexpr int OFFSETS[NEIGHBOR_COUNT][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+
+	static constexpr QPoint getNeighborOffset(int direction) { return QPoint(OFFSETS[direction][0], OFFSETS[direction][1]); }
+	static constexpr int getOppositeDirection(int direction) { return (direction + NEIGHBOR_COUNT / 2) % NEIGHBOR_COUNT; }
+	static constexpr int getRowStart(int) { return 0; }
+	static constexpr int getDistance(int dx, int dy) { return absolute(dx) + absolute(dy); }
+};
+
+//square cells that can also move diagonally. a diagonal move costs the same as a straight one
+struct Square8Topology : TopologyMath
+{
+	static const GridTopology TOPOLOGY = SQUARE8_TOPOLOGY;
+	static const int NEIGHBOR_COUNT = 8;
+	static constexpr int OFFSETS[NEIGHBOR_COUNT][2] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+	static constexpr QPoint getNeighborOffset(int direction) { return QPoint(OFFSETS[direction][0], OFFSETS[direction][1]); }
+	static constexpr int getOppositeDirection(int direction) { return (direction + NEIGHBOR_COUNT / 2) % NEIGHBOR_COUNT; }
+	static constexpr int getRowStart(int) { return 0; }
+	static constexpr int getDistance(int dx, int dy) { return maximum(absolute(dx), absolute(dy)); }
+};
+
+#endif // GRIDTOPOLOGY_H
@@ -0,0 +1,392 @@
+#include "hexgrid.h"
+
+#include <cmath>
+
+HexGrid::HexGrid(QObject *parent, int width, int height, GridTopology topology)
+	:QObject(parent), grid(width * height), passableNeighbors(width * height), allModified(true), width(width), height(height), topology(topology)
+{
+	//on a hex grid, the y axis is actually at a 60 degree angle to the x axis rather than going up and down
+	//so as we move further away from the x axis, the leftmost column that we keep track of on
+	//this square-like grid will increase, by one column for every 2 rows
+	//each row is stored contiguously, starting at that leftmost column. square grids just start every row at 0
+	rebuildPassableNeighbors();
+}
+
+GridTopology HexGrid::getTopology(void) const
+{
+	return topology;
+}
+
+QString HexGrid::getTopologyName(GridTopology topology)
+{
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		return "square4";
+	case SQUARE8_TOPOLOGY:
+		return "square8";
+	default:
+		return "hex";
+	}
+}
+
+bool HexGrid::parseTopology(const QString &name, GridTopology &topology)
+{
+	for (GridTopology candidate : { HEX_TOPOLOGY, SQUARE4_TOPOLOGY, SQUARE8_TOPOLOGY })
+	{
+		if (name == getTopologyName(candidate))
+		{
+			topology = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+QVector<QPoint> HexGrid::getNeighbors(const QPoint &p) const
+{
+	QVector<QPoint> results;
+	results.reserve(getNeighborCount());
+
+	for (int direction = 0; direction < getNeighborCount(); direction++)
+	{
+		QPoint testPoint = p + getNeighborOffset(direction);
+		if (isValidCell(testPoint))
+		{
+			results.push_back(testPoint);
+		}
+	}
+	return results;
+}
+
+quint8 HexGrid::getPassableNeighbors(const QPoint &p) const
+{
+	return passableNeighbors[getIndex(p)];
+}
+
+int HexGrid::getNeighborCount(void) const
+{
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		return Square4Topology::NEIGHBOR_COUNT;
+	case SQUARE8_TOPOLOGY:
+		return Square8Topology::NEIGHBOR_COUNT;
+	default:
+		return HexTopology::NEIGHBOR_COUNT;
+	}
+}
+
+QPoint HexGrid::getNeighborOffset(int direction) const
+{
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		return Square4Topology::getNeighborOffset(direction);
+	case SQUARE8_TOPOLOGY:
+		return Square8Topology::getNeighborOffset(direction);
+	default:
+		return HexTopology::getNeighborOffset(direction);
+	}
+}
+
+bool HexGrid::isValidCell(const QPoint &p) const
+{
+	int leftCol = getRowStart(p.y());
+
+	return p.y() >= 0 && p.y() < height && p.x() >= leftCol && p.x() < leftCol + width;
+}
+
+QPoint HexGrid::toCell(int column, int row) const
+{
+	return QPoint(getRowStart(row) + column, row);
+}
+
+
+GridEntry& HexGrid::getEntry(const QPoint &p)
+{
+	return grid[getIndex(p)];
+}
+
+const GridEntry& HexGrid::getEntry(const QPoint &p) const
+{
+	return grid[getIndex(p)];
+}
+
+void HexGrid::setType(const QPoint &p, GridEntry::EntryType type)
+{
+	GridEntry &entry = grid[getIndex(p)];
+	bool wasWall = entry.type == GridEntry::Wall;
+
+	entry.type = type;
+	markModified(p);
+
+	//the passable mask of a cell only depends on the types of its neighbors,
+	//so if this cell became a wall or stopped being one, flip the bit pointing back at it in each neighbor
+	if (wasWall != (type == GridEntry::Wall))
+	{
+		switch (topology)
+		{
+		case HEX_TOPOLOGY:
+			togglePassableFrom<HexTopology>(p);
+			break;
+		case SQUARE4_TOPOLOGY:
+			togglePassableFrom<Square4Topology>(p);
+			break;
+		case SQUARE8_TOPOLOGY:
+			togglePassableFrom<Square8Topology>(p);
+			break;
+		}
+	}
+}
+
+void HexGrid::markModified(const QPoint &p)
+{
+	int index = getIndex(p);
+	GridEntry &entry = grid[index];
+
+	//a cell that's already marked is already in the list, or every cell is marked
+	if (!entry.modified)
+	{
+		entry.modified = true;
+		modifiedCells.append(index);
+	}
+}
+
+bool HexGrid::takeModifiedCells(QVector<int> &cells)
+{
+	cells.clear();
+
+	if (allModified)
+	{
+		for (auto it = grid.begin(); it != grid.end(); it++)
+		{
+			it->modified = false;
+		}
+		modifiedCells.clear();
+		allModified = false;
+		return true;
+	}
+
+	for (int index : modifiedCells)
+	{
+		grid[index].modified = false;
+	}
+
+	//hand over the list, and keep the caller's empty one to fill next time, so neither of them reallocates
+	cells.swap(modifiedCells);
+	return false;
+}
+
+QList<QPoint> HexGrid::getCells(void) const
+{
+	QList<QPoint> results;
+	results.reserve(grid.size());
+
+	for (int i = 0; i < height; i++)
+	{
+		int leftCol = getRowStart(i);
+
+		for (int j = leftCol; j < leftCol + width; j++)
+		{
+			results.append(QPoint(j, i));
+		}
+	}
+	return results;
+}
+
+
+int HexGrid::getDistance(const QPoint &p1, const QPoint &p2) const
+{
+	int dx = p2.x() - p1.x();
+	int dy = p2.y() - p1.y();
+
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		return Square4Topology::getDistance(dx, dy);
+	case SQUARE8_TOPOLOGY:
+		return Square8Topology::getDistance(dx, dy);
+	default:
+		return HexTopology::getDistance(dx, dy);
+	}
+}
+
+QVector<QPoint> HexGrid::getLine(const QPoint &p1, const QPoint &p2)
+{
+	//walk the line in cube coordinates, where every neighbor is one step along two of the three axes
+	//the third axis of a cell (x, y) is y - x. see http://www.redblobgames.com/grids/hexagons/#line-drawing
+	int dx = p2.x() - p1.x();
+	int dy = p2.y() - p1.y();
+	int distance = qMax(qMax(qAbs(dx), qAbs(dy)), qAbs(dy - dx));
+
+	QVector<QPoint> line;
+	line.reserve(distance + 1);
+	line.append(p1);
+
+	for (int i = 1; i <= distance; i++)
+	{
+		//nudge the line off the exact edges between cells, so ties always round the same way
+		double t = double(i) / distance;
+		double x = p1.x() + dx * t + 1e-6;
+		double y = p1.y() + dy * t + 2e-6;
+		double z = y - x;
+
+		//round each axis, then fix up the one that moved the furthest so the three still agree
+		double roundedX = std::round(x);
+		double roundedY = std::round(y);
+		double roundedZ = std::round(z);
+
+		double errorX = std::abs(roundedX - x);
+		double errorY = std::abs(roundedY - y);
+		double errorZ = std::abs(roundedZ - z);
+
+		if (errorX > errorY && errorX > errorZ)
+			roundedX = roundedY - roundedZ;
+		else if (errorY > errorZ)
+			roundedY = roundedX + roundedZ;
+
+		line.append(QPoint(int(roundedX), int(roundedY)));
+	}
+	return line;
+}
+
+QVector<QPoint> HexGrid::getCellsInRadius(const QPoint &p, int radius)
+{
+	QVector<QPoint> cells;
+	for (int dx = -radius; dx <= radius; dx++)
+	{
+		//stay within the radius on the third axis too, see getLine
+		for (int dy = qMax(-radius, dx - radius); dy <= qMin(radius, dx + radius); dy++)
+		{
+			cells.append(QPoint(p.x() + dx, p.y() + dy));
+		}
+	}
+	return cells;
+}
+
+int HexGrid::getWidth(void) const
+{
+	return width;
+}
+int HexGrid::getHeight(void) const
+{
+	return height;
+}
+
+void HexGrid::resetSearched(void)
+{
+	for (auto it = grid.begin(); it != grid.end(); it++)
+	{
+		it->searched = false;
+		it->queued = false;
+		it->path = false;
+		it->modified = true;
+	}
+	modifiedCells.clear();
+	allModified = true;
+}
+
+void HexGrid::resetAll(void)
+{
+	for (auto it = grid.begin(); it != grid.end(); it++)
+	{
+		it->searched = false;
+		it->queued = false;
+		it->path = false;
+		it->modified = true;
+		it->type = GridEntry::Open;
+	}
+	modifiedCells.clear();
+	allModified = true;
+
+	//with no walls left, every valid neighbor is passable
+	rebuildPassableNeighbors();
+}
+
+size_t HexGrid::getMemoryUsage(void) const
+{
+	return sizeof(*this) + size_t(grid.capacity()) * sizeof(GridEntry) + size_t(passableNeighbors.capacity()) * sizeof(quint8)
+		+ size_t(modifiedCells.capacity()) * sizeof(int);
+}
+
+int HexGrid::getIndex(const QPoint &p) const
+{
+	return p.y() * width + p.x() - getRowStart(p.y());
+}
+
+int HexGrid::getCellCount(void) const
+{
+	return grid.size();
+}
+
+int HexGrid::getRowStart(int row) const
+{
+	return topology == HEX_TOPOLOGY ? HexTopology::getRowStart(row) : 0;
+}
+
+void HexGrid::rebuildPassableNeighbors(void)
+{
+	switch (topology)
+	{
+	case HEX_TOPOLOGY:
+		updateAllPassableNeighbors<HexTopology>();
+		break;
+	case SQUARE4_TOPOLOGY:
+		updateAllPassableNeighbors<Square4Topology>();
+		break;
+	case SQUARE8_TOPOLOGY:
+		updateAllPassableNeighbors<Square8Topology>();
+		break;
+	}
+}
+
+template<class Topology>
+void HexGrid::updatePassableNeighbors(const QPoint &p)
+{
+	quint8 mask = 0;
+	for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+	{
+		QPoint n = p + Topology::getNeighborOffset(direction);
+		if (isValidCell(n) && grid[getIndex(n)].type != GridEntry::Wall)
+		{
+			mask |= quint8(1 << direction);
+		}
+	}
+	passableNeighbors[getIndex(p)] = mask;
+}
+
+template<class Topology>
+void HexGrid::updateAllPassableNeighbors(void)
+{
+	for (int i = 0; i < height; i++)
+	{
+		int leftCol = Topology::getRowStart(i);
+
+		for (int j = leftCol; j < leftCol + width; j++)
+		{
+			updatePassableNeighbors<Topology>(QPoint(j, i));
+		}
+	}
+}
+
+template<class Topology>
+void HexGrid::togglePassableFrom(const QPoint &p)
+{
+	for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+	{
+		QPoint n = p + Topology::getNeighborOffset(direction);
+		if (isValidCell(n))
+		{
+			passableNeighbors[getIndex(n)] ^= quint8(1 << Topology::getOppositeDirection(direction));
+		}
+	}
+}
+
+uint qHash(const QPoint &p)
+{
+	uint hx = qHash(p.x());
+	uint hy = qHash(p.y());
+
+	return hx ^ ((hy << 16) | (hy >> 16));
+}
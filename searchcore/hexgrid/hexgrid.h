@@ -0,0 +1,137 @@
+#ifndef HEXGRID_H
+#define HEXGRID_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QPoint>
+#include <memory>
+
+#include "hexgrid/gridtopology.h"
+
+//return -1 if val is negative, 1 if val is positive
+template <typename T> inline
+int sign(T val) {
+	return (T(0) < val) - (val < T(0));
+}
+
+struct GridEntry {
+	enum EntryType { Start, End, Wall, Open } type;
+	bool searched;
+	bool queued;
+
+	//set through HexGrid::markModified, and cleared by HexGrid::takeModifiedCells
+	bool modified;
+	bool path;
+
+	GridEntry(void)
+        :type(GridEntry::Open), searched(false), queued(false), modified(true), path(false)
+	{}
+};
+
+class HexGrid : public QObject
+{
+	Q_OBJECT
+public:
+	//the most neighbors a cell has in any topology. a passable neighbor mask has one bit per neighbor
+	static const int MAX_NEIGHBOR_COUNT = 8;
+
+	//creates a "square" grid with "height" rows and "width" cells per row. the cells are hexes unless another topology is given
+	explicit HexGrid(QObject *parent, int width, int height, GridTopology topology = HEX_TOPOLOGY);
+
+	GridTopology getTopology(void) const;
+
+	//the name used for the topology on the command line. parseTopology returns false if the name isn't one of them
+	static QString getTopologyName(GridTopology topology);
+	static bool parseTopology(const QString &name, GridTopology &topology);
+
+	QVector<QPoint> getNeighbors(const QPoint &p) const;
+
+	//returns a bitmask where bit i is set if the neighbor in direction i is a valid cell that isn't a wall
+	//undefined if p is not a valid cell
+	quint8 getPassableNeighbors(const QPoint &p) const;
+
+	//returns the offset from a cell to its neighbor in the given direction, in the same order as the topology's table
+	//code that runs once per cell should be templated on the topology instead, see gridtopology.h
+	int getNeighborCount(void) const;
+	QPoint getNeighborOffset(int direction) const;
+
+	bool isValidCell(const QPoint &p) const;
+
+	//the cell in the given column of the given row, counting from the first cell of the row
+	QPoint toCell(int column, int row) const;
+
+	//undefined if p is not a valid cell
+	GridEntry& getEntry(const QPoint &p);
+	const GridEntry& getEntry(const QPoint &p) const;
+
+	//changes the type of the given cell, and updates the passable neighbor masks of the cells around it
+	//the type of a cell should only ever be changed through this method. undefined if p is not a valid cell
+	void setType(const QPoint &p, GridEntry::EntryType type);
+
+	//marks a cell as changed since it was last drawn. each marked cell is also kept in a list,
+	//so drawing the changes costs as much as the number of cells that changed, not the size of the grid
+	void markModified(const QPoint &p);
+
+	//moves the indexes of the cells marked since the last call into 'cells', and clears their marks
+	//returns true if every cell has changed since then, because the grid is new or was reset, in which case 'cells' is left empty
+	bool takeModifiedCells(QVector<int> &cells);
+
+	QList<QPoint> getCells(void) const;
+
+	//cells are numbered from 0 to getCellCount() - 1, in the same order getCells() returns them
+	//undefined if p is not a valid cell
+	int getIndex(const QPoint &p) const;
+	int getCellCount(void) const;
+
+	//the number of bytes the grid holds on to, for diagnostics
+	size_t getMemoryUsage(void) const;
+
+	//the number of moves from p1 to p2 if there were no walls in the way
+	int getDistance(const QPoint &p1, const QPoint &p2) const;
+
+	//returns the cells on the straight line from p1 to p2, including both ends. each cell is a neighbor of the one before it
+	//the cells aren't checked, so some may not be valid
+	static QVector<QPoint> getLine(const QPoint &p1, const QPoint &p2);
+
+	//returns every cell within the given number of steps of p, including p. the cells aren't checked, so some may not be valid
+	//getLine and getCellsInRadius assume hex cells
+	static QVector<QPoint> getCellsInRadius(const QPoint &p, int radius);
+	int getWidth(void) const;
+	int getHeight(void) const;
+
+	void resetSearched(void);
+	void resetAll(void);
+
+private:
+	//the x coordinate of the first cell in the given row
+	int getRowStart(int row) const;
+
+	//recomputes the passable mask of every cell
+	void rebuildPassableNeighbors(void);
+
+	template<class Topology>
+	void updatePassableNeighbors(const QPoint &p);
+
+	template<class Topology>
+	void updateAllPassableNeighbors(void);
+
+	//flips the bit pointing back at p in the passable mask of each of its neighbors
+	template<class Topology>
+	void togglePassableFrom(const QPoint &p);
+
+	//the cells are stored row by row. see the constructor for the layout of each row
+	QVector<GridEntry> grid;
+	QVector<quint8> passableNeighbors;
+
+	//the cells marked since the last takeModifiedCells. a reset marks every cell, which is only recorded as allModified
+	QVector<int> modifiedCells;
+	bool allModified;
+
+	int width, height;
+	GridTopology topology;
+};
+
+uint qHash(const QPoint &p);
+
+#endif // HEXGRID_H
@@ -0,0 +1,132 @@
+#include "movingaiimporter.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+#include "hexgrid/hexgrid.h"
+
+std::unique_ptr<HexGrid> MovingAIImporter::loadMap(const QString &fileName, QString &errorMessage, GridTopology topology)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(fileName, file.errorString());
+		return nullptr;
+	}
+
+	QTextStream stream(&file);
+
+	//the header is a list of "key value" lines, ending with a line that just says "map"
+	int width = 0, height = 0;
+	for (QString line = stream.readLine().trimmed(); line != "map"; line = stream.readLine().trimmed())
+	{
+		if (stream.atEnd())
+		{
+			errorMessage = QString("%1: missing \"map\" line").arg(fileName);
+			return nullptr;
+		}
+
+		QStringList fields = line.split(' ', QString::SkipEmptyParts);
+		if (fields.value(0) == "width")
+			width = fields.value(1).toInt();
+		else if (fields.value(0) == "height")
+			height = fields.value(1).toInt();
+	}
+
+	if (width <= 0 || height <= 0)
+	{
+		errorMessage = QString("%1: missing width or height").arg(fileName);
+		return nullptr;
+	}
+
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height, topology));
+
+	for (int y = 0; y < height; y++)
+	{
+		QString line = stream.readLine();
+		if (line.size() < width)
+		{
+			errorMessage = QString("%1: row %2 is shorter than the map width").arg(fileName).arg(y);
+			return nullptr;
+		}
+
+		for (int x = 0; x < width; x++)
+		{
+			//'.', 'G' and 'S' are passable terrain. '@' and 'O' are out of bounds, 'T' is trees and 'W' is water, which we treat as walls
+			switch (line.at(x).toLatin1())
+			{
+			case '.':
+			case 'G':
+			case 'S':
+				break;
+			default:
+				grid->setType(toCell(x, y, topology), GridEntry::Wall);
+				break;
+			}
+		}
+	}
+
+	return grid;
+}
+
+bool MovingAIImporter::loadScenarios(const QString &fileName, std::vector<Scenario> &scenarios, QString &errorMessage, GridTopology topology)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+
+	QTextStream stream(&file);
+
+	//each line is: bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+	//the first line is a version header, which we skip
+	stream.readLine();
+
+	for (int lineNumber = 2; !stream.atEnd(); lineNumber++)
+	{
+		QString line = stream.readLine();
+		if (line.trimmed().isEmpty())
+		{
+			continue;
+		}
+
+		QStringList fields = line.split('\t');
+		if (fields.size() < 9)
+		{
+			errorMessage = QString("%1: line %2 doesn't have 9 fields").arg(fileName).arg(lineNumber);
+			return false;
+		}
+
+		Scenario scenario;
+		scenario.mapName = fields[1];
+		scenario.mapWidth = fields[2].toInt();
+		scenario.mapHeight = fields[3].toInt();
+
+		int startX = fields[4].toInt(), startY = fields[5].toInt();
+		int goalX = fields[6].toInt(), goalY = fields[7].toInt();
+		if (startX < 0 || startX >= scenario.mapWidth || startY < 0 || startY >= scenario.mapHeight
+			|| goalX < 0 || goalX >= scenario.mapWidth || goalY < 0 || goalY >= scenario.mapHeight)
+		{
+			errorMessage = QString("%1: line %2 has a start or goal outside its %3x%4 map").arg(fileName).arg(lineNumber)
+				.arg(scenario.mapWidth).arg(scenario.mapHeight);
+			return false;
+		}
+
+		scenario.start = toCell(startX, startY, topology);
+		scenario.goal = toCell(goalX, goalY, topology);
+		scenario.octileLength = fields[8].toDouble();
+
+		scenarios.push_back(scenario);
+	}
+
+	return true;
+}
+
+QPoint MovingAIImporter::toCell(int x, int y, GridTopology topology)
+{
+	//each hex row starts at column y / 2, see HexGrid. square rows all start at column 0
+	return QPoint(x + (topology == HEX_TOPOLOGY ? HexTopology::getRowStart(y) : 0), y);
+}
@@ -0,0 +1,49 @@
+#ifndef MOVINGAIIMPORTER_H
+#define MOVINGAIIMPORTER_H
+
+#include <QString>
+#include <QPoint>
+#include <memory>
+#include <vector>
+
+#include "hexgrid/gridtopology.h"
+
+class HexGrid;
+
+//reads the .map and .scen files used by the MovingAI grid pathfinding benchmark sets
+//the square grid is mapped onto the grid row by row, so square cell (x, y) becomes the x'th cell of row y
+//the grid is hex unless another topology is asked for. every move costs 1 in every topology, including the diagonal moves of square8,
+//so the scenario's optimal octile lengths don't carry over
+class MovingAIImporter
+{
+public:
+	struct Scenario
+	{
+		QString mapName;
+
+		//the size the scenario file says the map is, in square cells
+		int mapWidth;
+		int mapHeight;
+
+		QPoint start;
+		QPoint goal;
+
+		//the optimal octile length from the scenario file
+		double octileLength;
+	};
+
+	//returns nullptr and sets errorMessage if the map couldn't be loaded
+	static std::unique_ptr<HexGrid> loadMap(const QString &fileName, QString &errorMessage, GridTopology topology = HEX_TOPOLOGY);
+
+	//returns false and sets errorMessage if the scenarios couldn't be loaded, or a start or goal is outside the map size on its line
+	//the start and goal cells are converted to cells of the given topology
+	static bool loadScenarios(const QString &fileName, std::vector<Scenario> &scenarios, QString &errorMessage, GridTopology topology = HEX_TOPOLOGY);
+
+	//converts a square grid coordinate to the matching cell of a grid with the given topology
+	static QPoint toCell(int x, int y, GridTopology topology);
+
+private:
+	MovingAIImporter() = default;
+};
+
+#endif // MOVINGAIIMPORTER_H
@@ -0,0 +1,488 @@
+#include "pathdatabase.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "hexgrid/hexgrid.h"
+#include "utils/littleendian.h"
+#include "utils/traceevents.h"
+
+namespace {
+	const char MAGIC[4] = { 'H', 'X', 'P', 'D' };
+	const quint32 VERSION = 1;
+
+	const qint64 HEADER_SIZE = 4 + 4 + 4 + 4 + 4 + 8 + 8;
+}
+
+PathDatabase::PathDatabase(void)
+	:width(0), height(0), topology(HEX_TOPOLOGY), buildMilliseconds(0)
+{
+}
+
+bool PathDatabase::build(const HexGrid &grid, int threadCount, QString &errorMessage)
+{
+	TRACE_SCOPE("PathDatabase::build");
+
+	//a run keeps the cell index in the bits above the move
+	if (quint64(grid.getCellCount()) >= (quint64(1) << (32 - MOVE_BITS)))
+	{
+		errorMessage = QString("The grid has %1 cells, but a path database can only hold %2").arg(grid.getCellCount()).arg(1 << (32 - MOVE_BITS));
+		return false;
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+
+	setGrid(grid);
+
+	if (threadCount <= 0)
+	{
+		threadCount = qMax(1, int(std::thread::hardware_concurrency()));
+	}
+
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		buildRows<Square4Topology>(threadCount);
+		break;
+	case SQUARE8_TOPOLOGY:
+		buildRows<Square8Topology>(threadCount);
+		break;
+	case HEX_TOPOLOGY:
+		buildRows<HexTopology>(threadCount);
+		break;
+	}
+
+	buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	return true;
+}
+
+bool PathDatabase::save(const QString &fileName, QString &errorMessage) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		errorMessage = QString("Couldn't create %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+
+	QByteArray header;
+	header.append(MAGIC, sizeof(MAGIC));
+	appendLittleEndian<quint32>(header, VERSION);
+	appendLittleEndian<quint32>(header, quint32(width));
+	appendLittleEndian<quint32>(header, quint32(height));
+	appendLittleEndian<quint32>(header, quint32(topology));
+	appendLittleEndian<quint64>(header, getWallHash());
+	appendLittleEndian<quint64>(header, quint64(runs.size()));
+	file.write(header);
+
+	QByteArray rows;
+	rows.reserve(int(rowOffsets.size() * 8));
+	for (quint64 offset : rowOffsets)
+	{
+		appendLittleEndian<quint64>(rows, offset);
+	}
+	file.write(rows);
+
+	//the runs can take hundreds of megabytes, so they're written a piece at a time
+	const size_t CHUNK_RUNS = 1 << 16;
+	QByteArray chunk;
+	for (size_t first = 0; first < runs.size(); first += CHUNK_RUNS)
+	{
+		chunk.clear();
+		for (size_t i = first; i < qMin(runs.size(), first + CHUNK_RUNS); i++)
+		{
+			appendLittleEndian<quint32>(chunk, runs[i]);
+		}
+		file.write(chunk);
+	}
+
+	if (file.error() != QFileDevice::NoError)
+	{
+		errorMessage = QString("Couldn't write %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+	return true;
+}
+
+bool PathDatabase::load(const QString &fileName, const HexGrid &grid, QString &errorMessage)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+	QByteArray bytes = file.readAll();
+	const uchar *data = reinterpret_cast<const uchar*>(bytes.constData());
+
+	setGrid(grid);
+	buildMilliseconds = 0;
+	rowOffsets.clear();
+	runs.clear();
+
+	errorMessage = QString("%1 is not a valid path database").arg(fileName);
+	if (bytes.size() < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || readLittleEndian<quint32>(data + 4) != VERSION)
+	{
+		return false;
+	}
+
+	if (int(readLittleEndian<quint32>(data + 8)) != width || int(readLittleEndian<quint32>(data + 12)) != height
+		|| readLittleEndian<quint32>(data + 16) != quint32(topology) || readLittleEndian<quint64>(data + 20) != getWallHash())
+	{
+		errorMessage = QString("%1 was built for a different map").arg(fileName);
+		return false;
+	}
+
+	//the run count comes from the file, so it's checked against the bytes left before it's multiplied or allocated
+	quint64 runCount = readLittleEndian<quint64>(data + 28);
+	size_t cellCount = passable.size();
+	quint64 rowBytes = (quint64(cellCount) + 1) * 8;
+	if (quint64(bytes.size()) < quint64(HEADER_SIZE) + rowBytes)
+	{
+		return false;
+	}
+	quint64 runBytes = quint64(bytes.size()) - HEADER_SIZE - rowBytes;
+	if (runCount > runBytes / 4 || runCount * 4 != runBytes)
+	{
+		return false;
+	}
+
+	const uchar *rowData = data + HEADER_SIZE;
+	const uchar *runData = rowData + (cellCount + 1) * 8;
+
+	rowOffsets.resize(cellCount + 1);
+	for (size_t i = 0; i <= cellCount; i++)
+	{
+		rowOffsets[i] = readLittleEndian<quint64>(rowData + i * 8);
+	}
+	if (rowOffsets.front() != 0 || rowOffsets.back() != runCount)
+	{
+		return false;
+	}
+	runs.resize(runCount);
+	for (size_t i = 0; i < runCount; i++)
+	{
+		runs[i] = readLittleEndian<quint32>(runData + i * 4);
+	}
+
+	//walls have empty rows, and an open cell with an open neighbor has at least one run. every row has to start at cell 0
+	//and go up from there, and every move has to be passable from the row's cell, so a lookup always finds a run
+	//and a path only ever steps onto open cells. walkPath still checks its moves, since a path can go round in circles
+	for (size_t row = 0; row < cellCount; row++)
+	{
+		if (rowOffsets[row] > rowOffsets[row + 1])
+		{
+			return false;
+		}
+
+		bool empty = rowOffsets[row] == rowOffsets[row + 1];
+		bool needsRuns = components[row] != NO_COMPONENT && passable[row] != 0;
+		if (empty == needsRuns)
+		{
+			return false;
+		}
+
+		for (quint64 i = rowOffsets[row]; i < rowOffsets[row + 1]; i++)
+		{
+			quint32 first = runs[i] >> MOVE_BITS;
+			bool ordered = i == rowOffsets[row] ? first == 0 : first > (runs[i - 1] >> MOVE_BITS);
+			if (!ordered || first >= cellCount || (passable[row] & (1 << (runs[i] & MOVE_MASK))) == 0)
+			{
+				return false;
+			}
+		}
+	}
+
+	errorMessage.clear();
+	return true;
+}
+
+bool PathDatabase::isReachable(const QPoint &start, const QPoint &goal) const
+{
+	int startCell = getCell(start);
+	int goalCell = getCell(goal);
+	return startCell >= 0 && goalCell >= 0 && components[startCell] != NO_COMPONENT && components[startCell] == components[goalCell];
+}
+
+int PathDatabase::getFirstMove(const QPoint &start, const QPoint &goal) const
+{
+	if (!isReachable(start, goal) || start == goal)
+	{
+		return -1;
+	}
+	return lookUp(getCell(start), getCell(goal));
+}
+
+std::vector<QPoint> PathDatabase::findPath(const QPoint &start, const QPoint &goal) const
+{
+	if (!isReachable(start, goal))
+	{
+		return std::vector<QPoint>();
+	}
+
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		return walkPath<Square4Topology>(getCell(start), getCell(goal));
+	case SQUARE8_TOPOLOGY:
+		return walkPath<Square8Topology>(getCell(start), getCell(goal));
+	default:
+		return walkPath<HexTopology>(getCell(start), getCell(goal));
+	}
+}
+
+size_t PathDatabase::getRunCount(void) const
+{
+	return runs.size();
+}
+
+size_t PathDatabase::getMemoryUsage(void) const
+{
+	return runs.capacity() * sizeof(quint32) + rowOffsets.capacity() * sizeof(quint64);
+}
+
+double PathDatabase::getBuildMilliseconds(void) const
+{
+	return buildMilliseconds;
+}
+
+void PathDatabase::setGrid(const HexGrid &grid)
+{
+	width = grid.getWidth();
+	height = grid.getHeight();
+	topology = grid.getTopology();
+
+	size_t cellCount = size_t(grid.getCellCount());
+	passable.assign(cellCount, 0);
+	components.assign(cellCount, quint32(NO_COMPONENT));
+
+	std::vector<bool> open(cellCount, false);
+	for (const QPoint &cell : grid.getCells())
+	{
+		int index = grid.getIndex(cell);
+		passable[index] = grid.getPassableNeighbors(cell);
+		open[index] = grid.getEntry(cell).type != GridEntry::Wall;
+	}
+
+	//flood fill each region that hasn't been reached yet. two cells in the same region always have a path between them
+	std::vector<int> queue;
+	quint32 componentCount = 0;
+	for (size_t first = 0; first < cellCount; first++)
+	{
+		if (!open[first] || components[first] != NO_COMPONENT)
+		{
+			continue;
+		}
+
+		components[first] = componentCount;
+		queue.assign(1, int(first));
+		for (size_t head = 0; head < queue.size(); head++)
+		{
+			QPoint position = toPoint(queue[head]);
+			for (int direction = 0; direction < grid.getNeighborCount(); direction++)
+			{
+				if (passable[queue[head]] & (1 << direction))
+				{
+					int neighbor = getCell(position + grid.getNeighborOffset(direction));
+					if (components[neighbor] == NO_COMPONENT)
+					{
+						components[neighbor] = componentCount;
+						queue.push_back(neighbor);
+					}
+				}
+			}
+		}
+		componentCount++;
+	}
+}
+
+int PathDatabase::getCell(const QPoint &p) const
+{
+	if (p.y() < 0 || p.y() >= height)
+	{
+		return -1;
+	}
+
+	int rowStart = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(p.y()) : 0;
+	int column = p.x() - rowStart;
+	return column >= 0 && column < width ? p.y() * width + column : -1;
+}
+
+QPoint PathDatabase::toPoint(int cell) const
+{
+	int row = cell / width;
+	int rowStart = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(row) : 0;
+	return QPoint(cell % width + rowStart, row);
+}
+
+template<class Topology>
+void PathDatabase::buildRows(int threadCount)
+{
+	int cellCount = int(passable.size());
+	std::vector<std::vector<quint32>> rows(cellCount);
+
+	std::atomic<int> nextSource(0);
+	auto worker = [this, cellCount, &rows, &nextSource]()
+	{
+		std::vector<qint8> firstMoves(cellCount);
+		std::vector<int> queue;
+		queue.reserve(cellCount);
+
+		for (;;)
+		{
+			int first = nextSource.fetch_add(SOURCE_BATCH);
+			if (first >= cellCount)
+			{
+				break;
+			}
+
+			for (int source = first; source < qMin(cellCount, first + SOURCE_BATCH); source++)
+			{
+				if (components[source] != NO_COMPONENT)
+				{
+					buildRow<Topology>(source, firstMoves, queue, rows[source]);
+				}
+			}
+		}
+	};
+
+	//the calling thread does its share too
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back([&worker]()
+		{
+			TRACE_THREAD_NAME("path database");
+			worker();
+		});
+	}
+	worker();
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	rowOffsets.assign(size_t(cellCount) + 1, 0);
+	for (int source = 0; source < cellCount; source++)
+	{
+		rowOffsets[source + 1] = rowOffsets[source] + rows[source].size();
+	}
+
+	runs.clear();
+	runs.shrink_to_fit();
+	runs.reserve(rowOffsets.back());
+	for (std::vector<quint32> &row : rows)
+	{
+		runs.insert(runs.end(), row.begin(), row.end());
+		std::vector<quint32>().swap(row);
+	}
+}
+
+template<class Topology>
+void PathDatabase::buildRow(int source, std::vector<qint8> &firstMoves, std::vector<int> &queue, std::vector<quint32> &row) const
+{
+	//-1 is a cell that hasn't been reached. the source counts as reached, so nothing steps back into it
+	std::fill(firstMoves.begin(), firstMoves.end(), qint8(-1));
+	firstMoves[source] = 0;
+	queue.clear();
+
+	//the source's neighbors are reached by their own direction, and every other cell by the same first move as the cell it was reached from
+	QPoint sourcePosition = toPoint(source);
+	for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+	{
+		if (passable[source] & (1 << direction))
+		{
+			int neighbor = getCell(sourcePosition + Topology::getNeighborOffset(direction));
+			firstMoves[neighbor] = qint8(direction);
+			queue.push_back(neighbor);
+		}
+	}
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int cell = queue[head];
+		QPoint position = toPoint(cell);
+		quint8 moves = passable[cell];
+		for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+		{
+			if (moves & (1 << direction))
+			{
+				QPoint neighborPosition = position + Topology::getNeighborOffset(direction);
+				int neighbor = neighborPosition.y() * width + neighborPosition.x() - Topology::getRowStart(neighborPosition.y());
+				if (firstMoves[neighbor] < 0)
+				{
+					firstMoves[neighbor] = firstMoves[cell];
+					queue.push_back(neighbor);
+				}
+			}
+		}
+	}
+
+	//the source itself is never asked about either
+	firstMoves[source] = -1;
+
+	//cells that weren't reached carry on the current run. the first run always starts at cell 0, so every lookup lands in a run
+	row.clear();
+	int currentMove = -1;
+	for (int cell = 0; cell < int(firstMoves.size()); cell++)
+	{
+		int move = firstMoves[cell];
+		if (move >= 0 && move != currentMove)
+		{
+			row.push_back((quint32(row.empty() ? 0 : cell) << MOVE_BITS) | quint32(move));
+			currentMove = move;
+		}
+	}
+}
+
+int PathDatabase::lookUp(int start, int goal) const
+{
+	//the last run that starts at or before the goal. -1 if the row is empty, which load never allows for a cell with somewhere to go
+	const quint32 *first = runs.data() + rowOffsets[start];
+	const quint32 *last = runs.data() + rowOffsets[start + 1];
+	if (first == last)
+	{
+		return -1;
+	}
+	const quint32 *run = std::upper_bound(first, last, (quint32(goal) << MOVE_BITS) | MOVE_MASK) - 1;
+	return int(*run & MOVE_MASK);
+}
+
+template<class Topology>
+std::vector<QPoint> PathDatabase::walkPath(int start, int goal) const
+{
+	std::vector<QPoint> path;
+	path.push_back(toPoint(start));
+
+	//a path never visits a cell twice, so it can't be longer than the number of cells
+	//a move that isn't passable, or a path that's too long, means the database doesn't match the walls, so there's no path
+	int cell = start;
+	while (cell != goal)
+	{
+		int move = lookUp(cell, goal);
+		if (move < 0 || (passable[cell] & (1 << move)) == 0 || path.size() >= passable.size())
+		{
+			return std::vector<QPoint>();
+		}
+
+		path.push_back(path.back() + Topology::getNeighborOffset(move));
+		cell = getCell(path.back());
+	}
+	return path;
+}
+
+quint64 PathDatabase::getWallHash(void) const
+{
+	//fnv-1a
+	quint64 hash = 14695981039346656037ull;
+	for (quint8 mask : passable)
+	{
+		hash = (hash ^ mask) * 1099511628211ull;
+	}
+	return hash;
+}
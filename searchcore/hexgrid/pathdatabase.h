@@ -0,0 +1,105 @@
+#ifndef PATHDATABASE_H
+#define PATHDATABASE_H
+
+#include <QPoint>
+#include <QString>
+#include <QtGlobal>
+
+#include <vector>
+
+#include "hexgrid/gridtopology.h"
+
+class HexGrid;
+
+//a compressed path database: the first move of a shortest path from every open cell to every other one, so a path is found by
+//following first moves from the start to the goal, without any search. it's only valid for the walls it was built with
+//
+//it's built offline with one search per source cell, spread across threads. every move costs 1, so each search is a breadth first
+//search, which is dijkstra without the priority queue. a source's row holds the first move toward every cell as a 3 bit direction,
+//in HexGrid::getIndex order. cells next to each other are usually reached by the same first move, so each row is stored as runs,
+//one 32 bit word per run holding the index of the run's first cell and its move. walls and cells the source can't reach never
+//get asked about, so they take whatever move keeps the current run going. finding a first move is a binary search in one row
+//
+//file layout, all integers little endian:
+//  header: "HXPD", u32 version, u32 width, u32 height, u32 topology, u64 hash of the walls, u64 run count
+//  rows:   u64 index of each row's first run, then one more for the end of the last row
+//  runs:   u32 per run, (first cell << 3) | move
+class PathDatabase
+{
+public:
+	PathDatabase(void);
+
+	//runs a search from every open cell of the grid. with a thread count of 0, one thread is used per core
+	//returns false if the grid has too many cells to fit a cell index in a run
+	bool build(const HexGrid &grid, int threadCount, QString &errorMessage);
+
+	bool save(const QString &fileName, QString &errorMessage) const;
+
+	//loads a database built for the given grid. returns false if it can't be read, or was built for a grid with different walls
+	bool load(const QString &fileName, const HexGrid &grid, QString &errorMessage);
+
+	bool isReachable(const QPoint &start, const QPoint &goal) const;
+
+	//the direction of the first move of a shortest path from start to goal, in the order of the topology's table
+	//-1 if either cell isn't an open cell, if they're the same cell, or if there's no path between them
+	int getFirstMove(const QPoint &start, const QPoint &goal) const;
+
+	//the path from start to goal, including both, or an empty vector if there is no path. the same as GridSearcher::findPath
+	std::vector<QPoint> findPath(const QPoint &start, const QPoint &goal) const;
+
+	size_t getRunCount(void) const;
+
+	//the number of bytes the runs and the row index take up
+	size_t getMemoryUsage(void) const;
+
+	//how long the last build took, or 0 if the database was loaded
+	double getBuildMilliseconds(void) const;
+
+private:
+	//sources are handed out to the threads this many at a time
+	static const int SOURCE_BATCH = 64;
+
+	static const int MOVE_BITS = 3;
+	static const quint32 MOVE_MASK = (1 << MOVE_BITS) - 1;
+
+	//the region of walls, which don't belong to any
+	static const quint32 NO_COMPONENT = 0xffffffff;
+
+	//copies the walls out of the grid, and works out which cells can reach each other
+	void setGrid(const HexGrid &grid);
+
+	//-1 if p isn't a valid cell
+	int getCell(const QPoint &p) const;
+	QPoint toPoint(int cell) const;
+
+	template<class Topology>
+	void buildRows(int threadCount);
+
+	//runs the search from one source, and compresses its first moves into the given row
+	//firstMoves and queue are scratch space, so each thread only allocates them once
+	template<class Topology>
+	void buildRow(int source, std::vector<qint8> &firstMoves, std::vector<int> &queue, std::vector<quint32> &row) const;
+
+	int lookUp(int start, int goal) const;
+
+	template<class Topology>
+	std::vector<QPoint> walkPath(int start, int goal) const;
+
+	//a hash of every cell's passable neighbor mask, so a saved database can tell whether it's being loaded for the same walls
+	quint64 getWallHash(void) const;
+
+	int width, height;
+	GridTopology topology;
+
+	//each cell's passable neighbor mask and connected region, indexed the same way as HexGrid::getIndex
+	std::vector<quint8> passable;
+	std::vector<quint32> components;
+
+	//row i is runs[rowOffsets[i]] up to but not including runs[rowOffsets[i + 1]]
+	std::vector<quint64> rowOffsets;
+	std::vector<quint32> runs;
+
+	double buildMilliseconds;
+};
+
+#endif // PATHDATABASE_H
@@ -0,0 +1,133 @@
+#include "searchservice.h"
+
+#include <chrono>
+
+#include "hexgrid/hexgrid.h"
+#include "utils/traceevents.h"
+
+SearchService::SearchService(int threadCount)
+	:jobs(), stopping(false)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = qMax(1, int(std::thread::hardware_concurrency()));
+	}
+
+	runningTokens.resize(threadCount);
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&SearchService::runWorker, this, size_t(i));
+	}
+}
+
+SearchService::~SearchService(void)
+{
+	{
+		std::unique_lock<std::mutex> locker(runningMutex);
+		stopping = true;
+
+		for (CancellationToken &token : runningTokens)
+		{
+			token.cancel();
+		}
+	}
+
+	//the workers finish off whatever is left in the queue as cancelled, then see the closed back and exit
+	jobs.closeBack();
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+std::future<SearchService::Result> SearchService::submit(
+	const HexGrid &grid,
+	GridSearcher::Engine engine,
+	const std::vector<QPoint> &startStates,
+	const std::vector<QPoint> &goalStates,
+	CancellationToken token,
+	std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel,
+	GridSearcher::Detail detail,
+	std::shared_ptr<std::atomic<size_t>> expandedProgress
+	)
+{
+	Job job;
+	job.grid = &grid;
+	job.engine = engine;
+	job.startStates = startStates;
+	job.goalStates = goalStates;
+	job.token = token;
+	job.outputChannel = outputChannel;
+	job.detail = detail;
+	job.expandedProgress = expandedProgress;
+
+	std::future<Result> future = job.promise.get_future();
+	jobs.push(std::move(job));
+	return future;
+}
+
+int SearchService::getThreadCount(void) const
+{
+	return int(workers.size());
+}
+
+void SearchService::runWorker(size_t workerIndex)
+{
+	TRACE_THREAD_NAME("search worker");
+
+	GridSearcher::Workspace workspace;
+
+	for (;;)
+	{
+		Job job;
+		if (!jobs.pop(job))
+		{
+			break;
+		}
+
+		{
+			std::unique_lock<std::mutex> locker(runningMutex);
+			if (stopping)
+			{
+				job.token.cancel();
+			}
+			runningTokens[workerIndex] = job.token;
+		}
+
+		Result result;
+		result.expandedStates = 0;
+		result.milliseconds = 0;
+
+		auto begin = std::chrono::steady_clock::now();
+
+		GridSearcher searcher(*job.grid, job.engine, job.detail);
+		if (job.token.isCancelled())
+		{
+			//don't even start, but still let the consumer know nothing is coming
+			if (job.outputChannel != nullptr)
+			{
+				job.outputChannel->closeBack();
+			}
+		}
+		else if (job.outputChannel != nullptr)
+		{
+			result.path = searcher.search(job.startStates, job.goalStates, job.outputChannel, workspace, job.token, &result.expandedStates,
+				job.expandedProgress.get());
+		}
+		else
+		{
+			result.path = searcher.findPath(job.startStates, job.goalStates, workspace, job.token, &result.expandedStates);
+		}
+
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		//the token can be cancelled just after the search finished, in which case the path it found still counts
+		result.cancelled = result.path.empty() && job.token.isCancelled();
+
+		{
+			std::unique_lock<std::mutex> locker(runningMutex);
+			runningTokens[workerIndex] = CancellationToken();
+		}
+
+		job.promise.set_value(std::move(result));
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef SEARCHSERVICE_H
+#define SEARCHSERVICE_H
+
+#include <QPoint>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hexgrid/gridsearcher.h"
+#include "hexgrid/gridsearchevent.h"
+#include "utils/cancellationtoken.h"
+#include "utils/channel.h"
+#include "utils/spscchannel.h"
+
+class HexGrid;
+
+//a fixed set of worker threads that run searches from a shared queue
+//each worker keeps its own GridSearcher::Workspace for its whole life, so once the workers have warmed up,
+//starting a search costs one push into the queue, and the open and closed sets don't allocate
+class SearchService
+{
+public:
+	struct Result
+	{
+		std::vector<QPoint> path;
+		size_t expandedStates;
+
+		//true if the search was cancelled before it finished, in which case the path is empty
+		bool cancelled;
+
+		//how long the search ran on its worker, not counting time spent in the queue
+		double milliseconds;
+	};
+
+	//with a thread count of 0, one worker is started per core
+	explicit SearchService(int threadCount = 0);
+	SearchService(const SearchService &other) = delete;
+
+	//cancels every search that hasn't finished, and waits for the workers to exit
+	~SearchService(void);
+
+	//queue a search. the grid must not be modified or destroyed until the returned future is ready
+	//if a channel is given, the search reports its progress into it the same way GridSearcher::search does,
+	//and the back of the channel is closed when the job is done, even if it's cancelled before it starts
+	//the detail only matters if a channel is given. so does expandedProgress, which the search keeps up to date with
+	//the number of states it has expanded so far, see GridSearcher::search
+	std::future<Result> submit(
+		const HexGrid &grid,
+		GridSearcher::Engine engine,
+		const std::vector<QPoint> &startStates,
+		const std::vector<QPoint> &goalStates,
+		CancellationToken token = CancellationToken(),
+		std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel = nullptr,
+		GridSearcher::Detail detail = GridSearcher::EXPANSIONS,
+		std::shared_ptr<std::atomic<size_t>> expandedProgress = nullptr
+		);
+
+	int getThreadCount(void) const;
+
+private:
+	struct Job
+	{
+		const HexGrid *grid;
+		GridSearcher::Engine engine;
+		std::vector<QPoint> startStates;
+		std::vector<QPoint> goalStates;
+		CancellationToken token;
+		std::shared_ptr<SpscChannel<GridSearchEvent>> outputChannel;
+		GridSearcher::Detail detail;
+		std::shared_ptr<std::atomic<size_t>> expandedProgress;
+
+		std::promise<Result> promise;
+	};
+
+	void runWorker(size_t workerIndex);
+
+	Channel<Job> jobs;
+	std::vector<std::thread> workers;
+
+	//the token of the job each worker is running, so shutting down can cancel them
+	std::mutex runningMutex;
+	std::vector<CancellationToken> runningTokens;
+	bool stopping;
+};
+
+#endif // SEARCHSERVICE_H
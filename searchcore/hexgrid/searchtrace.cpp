@@ -0,0 +1,504 @@
+#include "searchtrace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "hexgrid/hexgrid.h"
+#include "utils/littleendian.h"
+
+namespace {
+	const char HEADER_MAGIC[4] = { 'H', 'X', 'T', 'R' };
+	const char TRAILER_MAGIC[4] = { 'H', 'X', 'T', 'I' };
+	const quint32 VERSION = 1;
+
+	const qint64 HEADER_SIZE = 4 + 4 + 4 + 4 + 4;
+	const qint64 INDEX_ENTRY_SIZE = 8 + 8;
+	const qint64 TRAILER_SIZE = 8 + 4 + 8 + 4;
+
+	//codes 0 to 5 are a step in that direction, in the same order as HexTopology's table
+	//steps on a square grid that aren't also hex moves are written as jumps
+	//a jump is followed by the offset to the new cell in the escape stream, and a type change by the new type and then the offset
+	const int CODE_BITS = 3;
+	const int JUMP_CODE = 6;
+	const int TYPE_CODE = 7;
+
+	void appendVarint(QByteArray &bytes, quint32 value)
+	{
+		while (value >= 0x80)
+		{
+			bytes.append(char((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		bytes.append(char(value));
+	}
+
+	//returns false if the varint runs past the end or is too long to be a quint32
+	bool readVarint(const uchar *&p, const uchar *end, quint32 &value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (p == end)
+				return false;
+
+			uchar byte = *p++;
+			value |= quint32(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	//maps small negative numbers to small positive ones, so they still fit in a short varint
+	quint32 zigzag(qint32 value)
+	{
+		return (quint32(value) << 1) ^ quint32(value >> 31);
+	}
+
+	qint32 unzigzag(quint32 value)
+	{
+		return qint32(value >> 1) ^ -qint32(value & 1);
+	}
+
+	//returns -1 if the offset isn't a step to a neighbor
+	int neighborDirection(const QPoint &offset)
+	{
+		for (int direction = 0; direction < HexTopology::NEIGHBOR_COUNT; direction++)
+		{
+			if (HexTopology::getNeighborOffset(direction) == offset)
+				return direction;
+		}
+		return -1;
+	}
+}
+
+SearchTraceWriter::SearchTraceWriter(void)
+	:eventCount(0)
+{
+}
+
+SearchTraceWriter::~SearchTraceWriter(void)
+{
+	if (file.isOpen())
+	{
+		QString errorMessage;
+		close(errorMessage);
+	}
+}
+
+bool SearchTraceWriter::open(const QString &fileName, const HexGrid &grid, QString &errorMessage)
+{
+	//the trace doesn't store the topology, and replays always load the map as hex cells
+	if (grid.getTopology() != HEX_TOPOLOGY)
+	{
+		errorMessage = QString("Couldn't create %1: traces can only be recorded on hex grids").arg(fileName);
+		return false;
+	}
+
+	file.setFileName(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		errorMessage = QString("Couldn't create %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+
+	//one byte per cell compresses down to almost nothing for typical maps
+	QByteArray cellTypes;
+	cellTypes.reserve(grid.getCellCount());
+	for (const QPoint &cell : grid.getCells())
+	{
+		cellTypes.append(char(grid.getEntry(cell).type));
+	}
+	QByteArray compressedMap = qCompress(cellTypes);
+
+	QByteArray header;
+	header.append(HEADER_MAGIC, sizeof(HEADER_MAGIC));
+	appendLittleEndian<quint32>(header, VERSION);
+	appendLittleEndian<quint32>(header, grid.getWidth());
+	appendLittleEndian<quint32>(header, grid.getHeight());
+	appendLittleEndian<quint32>(header, compressedMap.size());
+	header.append(compressedMap);
+	file.write(header);
+
+	pendingEvents.clear();
+	pendingEvents.reserve(BLOCK_EVENT_COUNT);
+	blockOffsets.clear();
+	blockFirstEvents.clear();
+	eventCount = 0;
+	return true;
+}
+
+void SearchTraceWriter::write(const GridSearchEvent &event)
+{
+	pendingEvents.push_back(event);
+	eventCount++;
+
+	if (pendingEvents.size() >= size_t(BLOCK_EVENT_COUNT))
+	{
+		writeBlock();
+	}
+}
+
+void SearchTraceWriter::write(const std::vector<GridSearchEvent> &events)
+{
+	for (const GridSearchEvent &event : events)
+	{
+		write(event);
+	}
+}
+
+bool SearchTraceWriter::close(QString &errorMessage)
+{
+	writeBlock();
+
+	QByteArray index;
+	for (size_t i = 0; i < blockOffsets.size(); i++)
+	{
+		appendLittleEndian<quint64>(index, blockOffsets[i]);
+		appendLittleEndian<quint64>(index, blockFirstEvents[i]);
+	}
+
+	appendLittleEndian<quint64>(index, quint64(file.pos()));
+	appendLittleEndian<quint32>(index, quint32(blockOffsets.size()));
+	appendLittleEndian<quint64>(index, eventCount);
+	index.append(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+	file.write(index);
+
+	//every write above goes through the same file, so any failure shows up here
+	bool ok = file.error() == QFileDevice::NoError;
+	if (!ok)
+	{
+		errorMessage = QString("Couldn't write %1: %2").arg(file.fileName(), file.errorString());
+	}
+	file.close();
+	return ok;
+}
+
+quint64 SearchTraceWriter::getEventCount(void) const
+{
+	return eventCount;
+}
+
+bool SearchTraceWriter::save(const QString &fileName, const HexGrid &grid, const std::vector<GridSearchEvent> &events, QString &errorMessage)
+{
+	SearchTraceWriter writer;
+	if (!writer.open(fileName, grid, errorMessage))
+	{
+		return false;
+	}
+	writer.write(events);
+	return writer.close(errorMessage);
+}
+
+void SearchTraceWriter::writeBlock(void)
+{
+	if (pendingEvents.empty())
+	{
+		return;
+	}
+
+	QByteArray codes, escapes;
+	codes.reserve(int(pendingEvents.size() * CODE_BITS / 8 + 1));
+
+	quint32 bitBuffer = 0;
+	int bitCount = 0;
+
+	//every block starts from the same state, so blocks can be decoded independently
+	GridSearchEvent previous(GridSearchEvent::EXPAND, QPoint(0, 0));
+	for (const GridSearchEvent &event : pendingEvents)
+	{
+		QPoint offset = event.point - previous.point;
+
+		int code;
+		if (event.eventType != previous.eventType)
+		{
+			code = TYPE_CODE;
+			appendVarint(escapes, quint32(event.eventType));
+		}
+		else
+		{
+			code = neighborDirection(offset);
+			if (code < 0)
+				code = JUMP_CODE;
+		}
+
+		if (code >= JUMP_CODE)
+		{
+			appendVarint(escapes, zigzag(offset.x()));
+			appendVarint(escapes, zigzag(offset.y()));
+		}
+
+		bitBuffer |= quint32(code) << bitCount;
+		bitCount += CODE_BITS;
+		while (bitCount >= 8)
+		{
+			codes.append(char(bitBuffer & 0xff));
+			bitBuffer >>= 8;
+			bitCount -= 8;
+		}
+
+		previous = event;
+	}
+	if (bitCount > 0)
+	{
+		codes.append(char(bitBuffer));
+	}
+
+	QByteArray block;
+	appendVarint(block, quint32(pendingEvents.size()));
+	appendVarint(block, quint32(codes.size()));
+	block.append(codes);
+	block.append(escapes);
+
+	QByteArray compressed = qCompress(block);
+
+	blockOffsets.push_back(quint64(file.pos()));
+	blockFirstEvents.push_back(eventCount - pendingEvents.size());
+
+	QByteArray sizePrefix;
+	appendLittleEndian<quint32>(sizePrefix, compressed.size());
+	file.write(sizePrefix);
+	file.write(compressed);
+
+	pendingEvents.clear();
+}
+
+
+
+SearchTraceReader::SearchTraceReader(void)
+	:data(nullptr), size(0), width(0), height(0), topology(HEX_TOPOLOGY), indexOffset(0), eventCount(0)
+{
+}
+
+SearchTraceReader::~SearchTraceReader(void)
+{
+	if (data != nullptr && buffer.isEmpty())
+	{
+		file.unmap(const_cast<uchar*>(data));
+	}
+}
+
+bool SearchTraceReader::open(const QString &fileName, QString &errorMessage)
+{
+	file.setFileName(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(fileName, file.errorString());
+		return false;
+	}
+
+	//blocks are only decoded when they're replayed, so mapping the file means we never hold more than one block in memory ourselves
+	size = file.size();
+	data = size > 0 ? file.map(0, size) : nullptr;
+	if (data == nullptr)
+	{
+		buffer = file.readAll();
+		data = reinterpret_cast<const uchar*>(buffer.constData());
+		size = buffer.size();
+	}
+
+	errorMessage = QString("%1 is not a valid search trace").arg(fileName);
+
+	if (size < HEADER_SIZE + TRAILER_SIZE
+		|| memcmp(data, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0
+		|| memcmp(data + size - sizeof(TRAILER_MAGIC), TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0
+		|| readLittleEndian<quint32>(data + 4) != VERSION)
+	{
+		return false;
+	}
+
+	width = int(readLittleEndian<quint32>(data + 8));
+	height = int(readLittleEndian<quint32>(data + 12));
+	quint32 mapSize = readLittleEndian<quint32>(data + 16);
+	if (width <= 0 || height <= 0 || mapSize > quint64(size - HEADER_SIZE - TRAILER_SIZE))
+	{
+		return false;
+	}
+	compressedMap = QByteArray(reinterpret_cast<const char*>(data + HEADER_SIZE), int(mapSize));
+
+	const uchar *trailer = data + size - TRAILER_SIZE;
+	indexOffset = readLittleEndian<quint64>(trailer);
+	quint32 blockCount = readLittleEndian<quint32>(trailer + 8);
+	eventCount = readLittleEndian<quint64>(trailer + 12);
+
+	if (indexOffset < quint64(HEADER_SIZE + mapSize) || indexOffset + quint64(blockCount) * INDEX_ENTRY_SIZE != quint64(size - TRAILER_SIZE))
+	{
+		return false;
+	}
+
+	blockOffsets.resize(blockCount);
+	blockFirstEvents.resize(blockCount);
+	for (quint32 i = 0; i < blockCount; i++)
+	{
+		blockOffsets[i] = readLittleEndian<quint64>(data + indexOffset + i * INDEX_ENTRY_SIZE);
+		blockFirstEvents[i] = readLittleEndian<quint64>(data + indexOffset + i * INDEX_ENTRY_SIZE + 8);
+
+		if (blockOffsets[i] + 4 > indexOffset || blockFirstEvents[i] > eventCount || (i > 0 && blockFirstEvents[i] < blockFirstEvents[i - 1]))
+		{
+			return false;
+		}
+	}
+
+	errorMessage.clear();
+	return true;
+}
+
+int SearchTraceReader::getWidth(void) const
+{
+	return width;
+}
+
+int SearchTraceReader::getHeight(void) const
+{
+	return height;
+}
+
+quint64 SearchTraceReader::getEventCount(void) const
+{
+	return eventCount;
+}
+
+int SearchTraceReader::getBlockCount(void) const
+{
+	return int(blockOffsets.size());
+}
+
+bool SearchTraceReader::isValidCell(const QPoint &p) const
+{
+	int leftCol = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(p.y()) : 0;
+
+	return p.y() >= 0 && p.y() < height && p.x() >= leftCol && p.x() < leftCol + width;
+}
+
+std::unique_ptr<HexGrid> SearchTraceReader::createGrid(void) const
+{
+	QByteArray cellTypes = qUncompress(compressedMap);
+	if (cellTypes.size() != width * height)
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<HexGrid> grid(new HexGrid(nullptr, width, height));
+
+	QList<QPoint> cells = grid->getCells();
+	for (int i = 0; i < cells.size(); i++)
+	{
+		int type = cellTypes.at(i);
+		if (type < GridEntry::Start || type > GridEntry::Open)
+		{
+			return nullptr;
+		}
+		if (type != GridEntry::Open)
+		{
+			grid->setType(cells[i], GridEntry::EntryType(type));
+		}
+	}
+	return grid;
+}
+
+bool SearchTraceReader::readBlock(int block, std::vector<GridSearchEvent> &events) const
+{
+	if (block < 0 || block >= getBlockCount())
+	{
+		return false;
+	}
+
+	const uchar *blockStart = data + blockOffsets[block];
+	quint32 compressedSize = readLittleEndian<quint32>(blockStart);
+	if (blockOffsets[block] + 4 + compressedSize > indexOffset)
+	{
+		return false;
+	}
+
+	QByteArray decompressed = qUncompress(blockStart + 4, int(compressedSize));
+
+	const uchar *p = reinterpret_cast<const uchar*>(decompressed.constData());
+	const uchar *end = p + decompressed.size();
+
+	quint32 count, codeBytes;
+	if (!readVarint(p, end, count) || !readVarint(p, end, codeBytes) || codeBytes > quint32(end - p) || quint64(codeBytes) * 8 < quint64(count) * CODE_BITS)
+	{
+		return false;
+	}
+
+	//the index tells us how many events should be in this block, so a truncated block can't go unnoticed
+	quint64 blockEnd = block + 1 < getBlockCount() ? blockFirstEvents[block + 1] : eventCount;
+	if (count != blockEnd - blockFirstEvents[block])
+	{
+		return false;
+	}
+
+	const uchar *codes = p;
+	p += codeBytes;
+
+	events.reserve(events.size() + count);
+
+	GridSearchEvent previous(GridSearchEvent::EXPAND, QPoint(0, 0));
+	for (quint32 i = 0; i < count; i++)
+	{
+		//a code can straddle two bytes
+		quint32 bit = i * CODE_BITS;
+		quint32 byte = bit / 8;
+		quint32 bits = codes[byte] | (byte + 1 < codeBytes ? quint32(codes[byte + 1]) << 8 : 0);
+		int code = int((bits >> (bit % 8)) & ((1 << CODE_BITS) - 1));
+
+		if (code < HexTopology::NEIGHBOR_COUNT)
+		{
+			previous.point += HexTopology::getNeighborOffset(code);
+		}
+		else
+		{
+			if (code == TYPE_CODE)
+			{
+				quint32 type;
+				if (!readVarint(p, end, type) || type > GridSearchEvent::BACKTRACE)
+				{
+					return false;
+				}
+				previous.eventType = GridSearchEvent::EventType(type);
+			}
+
+			quint32 dx, dy;
+			if (!readVarint(p, end, dx) || !readVarint(p, end, dy))
+			{
+				return false;
+			}
+			previous.point += QPoint(unzigzag(dx), unzigzag(dy));
+		}
+
+		//a corrupt block could send the search off the grid, and replays index the grid with these points
+		if (!isValidCell(previous.point))
+		{
+			return false;
+		}
+		events.push_back(previous);
+	}
+	return true;
+}
+
+bool SearchTraceReader::replay(std::shared_ptr<SpscChannel<GridSearchEvent>> channel, quint64 firstEvent) const
+{
+	//start from the last block that begins at or before the first event we want
+	int block = int(std::upper_bound(blockFirstEvents.begin(), blockFirstEvents.end(), firstEvent) - blockFirstEvents.begin()) - 1;
+
+	std::vector<GridSearchEvent> events;
+	events.reserve(SearchTraceWriter::BLOCK_EVENT_COUNT);
+
+	bool ok = true;
+	for (block = qMax(block, 0); ok && block < getBlockCount(); block++)
+	{
+		events.clear();
+		if (!readBlock(block, events))
+		{
+			ok = false;
+			break;
+		}
+
+		size_t skip = size_t(qMin(quint64(events.size()), firstEvent > blockFirstEvents[block] ? firstEvent - blockFirstEvents[block] : 0));
+		ok = channel->pushMany(std::make_move_iterator(events.begin() + skip), std::make_move_iterator(events.end()));
+	}
+
+	channel->closeBack();
+	return ok;
+}
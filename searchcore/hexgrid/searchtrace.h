@@ -0,0 +1,110 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "hexgrid/gridsearchevent.h"
+#include "hexgrid/gridtopology.h"
+#include "utils/spscchannel.h"
+
+class HexGrid;
+
+//a search trace is a file holding the grid a search ran on and every event it produced, so the search can be replayed later
+//
+//events are stored in blocks of BLOCK_EVENT_COUNT. within a block, every event gets a 3 bit code. an event that moves one step
+//from the previous event's cell and has the same type is stored as just the direction of that step. anything else is an escape
+//code, followed in a separate byte stream by the new type if it changed, and the zigzag varint offset from the previous cell
+//each block is then compressed on its own, and an index of where every block starts is written at the end of the file,
+//so a reader can start from any block
+//
+//layout, all integers little endian:
+//  header:  "HXTR", u32 version, u32 width, u32 height, u32 map size, compressed map (one byte per cell type, in getCells() order)
+//  blocks:  u32 compressed size, compressed block
+//  index:   u64 file offset and u64 first event of each block
+//  trailer: u64 index offset, u32 block count, u64 event count, "HXTI"
+class SearchTraceWriter
+{
+public:
+	SearchTraceWriter(void);
+	~SearchTraceWriter(void);
+
+	//create the file and write the header, including the cell types of the grid
+	//returns false and sets errorMessage if the file couldn't be created
+	bool open(const QString &fileName, const HexGrid &grid, QString &errorMessage);
+
+	//add events to the end of the trace. they're written out a block at a time
+	void write(const GridSearchEvent &event);
+	void write(const std::vector<GridSearchEvent> &events);
+
+	//write the last block and the index. returns false and sets errorMessage if anything failed to be written
+	bool close(QString &errorMessage);
+
+	quint64 getEventCount(void) const;
+
+	//write a whole trace in one go
+	static bool save(const QString &fileName, const HexGrid &grid, const std::vector<GridSearchEvent> &events, QString &errorMessage);
+
+	static const int BLOCK_EVENT_COUNT = 4096;
+
+private:
+	void writeBlock(void);
+
+	QFile file;
+	std::vector<GridSearchEvent> pendingEvents;
+
+	std::vector<quint64> blockOffsets;
+	std::vector<quint64> blockFirstEvents;
+	quint64 eventCount;
+};
+
+class SearchTraceReader
+{
+public:
+	SearchTraceReader(void);
+	~SearchTraceReader(void);
+
+	//open a trace and read its header and index. the file is memory mapped if possible, and read into memory if not
+	//returns false and sets errorMessage if the file couldn't be read or isn't a valid trace
+	bool open(const QString &fileName, QString &errorMessage);
+
+	int getWidth(void) const;
+	int getHeight(void) const;
+	quint64 getEventCount(void) const;
+	int getBlockCount(void) const;
+
+	//create a grid with the same size and cell types as the one the trace was recorded on. returns nullptr if the map is corrupt
+	std::unique_ptr<HexGrid> createGrid(void) const;
+
+	//decode one block and add its events onto the end of 'events'. returns false if the block is corrupt
+	bool readBlock(int block, std::vector<GridSearchEvent> &events) const;
+
+	//decode the trace a block at a time, starting at the given event, and push every event into the channel
+	//the back of the channel is closed at the end. returns false if the trace was corrupt or the front of the channel was closed
+	bool replay(std::shared_ptr<SpscChannel<GridSearchEvent>> channel, quint64 firstEvent = 0) const;
+
+private:
+	//true if the point is a cell of the grid the trace was recorded on, see HexGrid::isValidCell
+	bool isValidCell(const QPoint &p) const;
+
+	const uchar *data;
+	qint64 size;
+
+	QFile file;
+	QByteArray buffer;
+
+	//traces are only written from hex grids, but the row layout is kept with the size so events can be checked like HexGrid does
+	int width, height;
+	GridTopology topology;
+	QByteArray compressedMap;
+
+	quint64 indexOffset;
+	std::vector<quint64> blockOffsets;
+	std::vector<quint64> blockFirstEvents;
+	quint64 eventCount;
+};
+
+#endif // SEARCHTRACE_H
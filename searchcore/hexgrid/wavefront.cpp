@@ -0,0 +1,630 @@
+#include "wavefront.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "hexgrid/hexgrid.h"
+#include "utils/traceevents.h"
+
+namespace {
+	//the threads only wait for each other for a few microseconds per step, so waiting spins instead of sleeping
+	class SpinBarrier
+	{
+	public:
+		explicit SpinBarrier(int threadCount)
+			:threadCount(threadCount), waiting(0), generation(0)
+		{}
+
+		void wait(void)
+		{
+			int currentGeneration = generation.load(std::memory_order_acquire);
+			if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == threadCount)
+			{
+				//the last thread to arrive lets the others go
+				waiting.store(0, std::memory_order_relaxed);
+				generation.fetch_add(1, std::memory_order_release);
+				return;
+			}
+
+			while (generation.load(std::memory_order_acquire) == currentGeneration)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		const int threadCount;
+		std::atomic<int> waiting;
+		std::atomic<int> generation;
+	};
+
+	//the index of the lowest set bit. the bits below it are the only ones set in (lowest - 1)
+	int lowestBit(quint64 bits)
+	{
+		return int(qPopulationCount((bits & (~bits + 1)) - 1));
+	}
+
+	//one word of a row, moved the given number of columns to the right. the shift is always -1, 0 or 1
+	quint64 shiftedWord(const quint64 *row, int word, int words, int shift)
+	{
+		if (shift > 0)
+			return (row[word] << 1) | (word > 0 ? row[word - 1] >> 63 : 0);
+		if (shift < 0)
+			return (row[word] >> 1) | (word + 1 < words ? row[word + 1] << 63 : 0);
+		return row[word];
+	}
+
+	//ors the given word marks into the destination, along with the words on either side of each one
+	void orDilated(quint64 *destination, const quint64 *marks, int words)
+	{
+		for (int i = 0; i < words; i++)
+		{
+			quint64 dilated = marks[i] | (marks[i] << 1) | (marks[i] >> 1);
+			if (i > 0)
+				dilated |= marks[i - 1] >> 63;
+			if (i + 1 < words)
+				dilated |= marks[i + 1] << 63;
+			destination[i] |= dilated;
+		}
+	}
+
+	//spreads every set bit toward the higher bits, for as long as the open bits continue. each round doubles how far it has spread
+	quint64 fillUp(quint64 cells, quint64 open)
+	{
+		cells |= open & (cells << 1);
+		open &= open << 1;
+		cells |= open & (cells << 2);
+		open &= open << 2;
+		cells |= open & (cells << 4);
+		open &= open << 4;
+		cells |= open & (cells << 8);
+		open &= open << 8;
+		cells |= open & (cells << 16);
+		open &= open << 16;
+		return cells | (open & (cells << 32));
+	}
+
+	quint64 fillDown(quint64 cells, quint64 open)
+	{
+		cells |= open & (cells >> 1);
+		open &= open >> 1;
+		cells |= open & (cells >> 2);
+		open &= open >> 2;
+		cells |= open & (cells >> 4);
+		open &= open >> 4;
+		cells |= open & (cells >> 8);
+		open &= open >> 8;
+		cells |= open & (cells >> 16);
+		open &= open >> 16;
+		return cells | (open & (cells >> 32));
+	}
+
+	//spreads the cells in a row over the whole open run each one is in, carrying across words in both directions
+	void fillRuns(quint64 *cells, const quint64 *open, int words)
+	{
+		quint64 carry = 0;
+		for (int i = 0; i < words; i++)
+		{
+			cells[i] = fillUp(cells[i] | (carry & open[i]), open[i]);
+			carry = cells[i] >> 63;
+		}
+
+		carry = 0;
+		for (int i = words - 1; i >= 0; i--)
+		{
+			cells[i] = fillDown(cells[i] | ((carry << 63) & open[i]), open[i]);
+			carry = cells[i] & 1;
+		}
+	}
+}
+
+Wavefront::Wavefront(const HexGrid &grid)
+	:width(grid.getWidth()), height(grid.getHeight()), wordsPerRow((grid.getWidth() + 63) / 64), topology(grid.getTopology()),
+	markWordsPerRow((wordsPerRow + 63) / 64), furthestDistance(-1)
+{
+	//bits past the end of a row stay clear in the passable mask, so nothing shifted into them ever joins the frontier
+	passable.assign(size_t(height) * wordsPerRow, 0);
+	for (int row = 0; row < height; row++)
+	{
+		quint64 *rowBits = passable.data() + size_t(row) * wordsPerRow;
+		for (int column = 0; column < width; column++)
+		{
+			if (grid.getEntry(grid.toCell(column, row)).type != GridEntry::Wall)
+			{
+				rowBits[column / 64] |= quint64(1) << (column % 64);
+			}
+		}
+	}
+}
+
+bool Wavefront::run(const std::vector<QPoint> &startStates, Output output, int threadCount)
+{
+	TRACE_SCOPE("Wavefront::run");
+
+	bool findDistances = output == DISTANCES;
+	reached.assign(size_t(height) * wordsPerRow, 0);
+	activeRows[0].assign(height, 0);
+	furthestDistance = -1;
+
+	if (findDistances)
+	{
+		frontiers[0].assign(size_t(height) * wordsPerRow, 0);
+		frontiers[1].assign(size_t(height) * wordsPerRow, 0);
+		wordMarks[0].assign(size_t(height) * markWordsPerRow, 0);
+		wordMarks[1].assign(size_t(height) * markWordsPerRow, 0);
+		activeRows[1].assign(height, 0);
+		distances.assign(size_t(width) * height, -1);
+	}
+	else
+	{
+		distances.clear();
+	}
+
+	bool anyStart = false;
+	for (const QPoint &start : startStates)
+	{
+		int column = getColumn(start);
+		if (column < 0)
+		{
+			continue;
+		}
+
+		size_t word = size_t(start.y()) * wordsPerRow + column / 64;
+		quint64 bit = quint64(1) << (column % 64);
+		if ((passable[word] & bit) == 0)
+		{
+			continue;
+		}
+
+		reached[word] |= bit;
+		activeRows[0][start.y()] = 1;
+		if (findDistances)
+		{
+			frontiers[0][word] |= bit;
+			wordMarks[0][size_t(start.y()) * markWordsPerRow + column / 64 / 64] |= quint64(1) << (column / 64 % 64);
+			distances[size_t(start.y()) * width + column] = 0;
+		}
+		anyStart = true;
+	}
+
+	if (!anyStart)
+	{
+		return false;
+	}
+
+	//there's no point in having more threads than stripes of rows
+	if (threadCount <= 0)
+	{
+		threadCount = qMax(1, int(std::thread::hardware_concurrency()));
+	}
+	threadCount = qMax(1, qMin(threadCount, (height + STRIPE_ROWS - 1) / STRIPE_ROWS));
+
+	switch (topology)
+	{
+	case SQUARE4_TOPOLOGY:
+		if (findDistances)
+			spreadLayers<Square4Topology>(threadCount);
+		else
+			fill<Square4Topology>(threadCount);
+		break;
+	case SQUARE8_TOPOLOGY:
+		if (findDistances)
+			spreadLayers<Square8Topology>(threadCount);
+		else
+			fill<Square8Topology>(threadCount);
+		break;
+	case HEX_TOPOLOGY:
+		if (findDistances)
+			spreadLayers<HexTopology>(threadCount);
+		else
+			fill<HexTopology>(threadCount);
+		break;
+	}
+	return true;
+}
+
+bool Wavefront::isReachable(const QPoint &p) const
+{
+	int column = getColumn(p);
+	return column >= 0 && !reached.empty() && (reached[size_t(p.y()) * wordsPerRow + column / 64] >> (column % 64)) & 1;
+}
+
+int Wavefront::getDistance(const QPoint &p) const
+{
+	int column = getColumn(p);
+	if (column < 0 || distances.empty())
+	{
+		return -1;
+	}
+	return distances[size_t(p.y()) * width + column];
+}
+
+const std::vector<int>& Wavefront::getDistances(void) const
+{
+	return distances;
+}
+
+int Wavefront::getFurthestDistance(void) const
+{
+	return furthestDistance;
+}
+
+const std::vector<quint64>& Wavefront::getReachableMask(void) const
+{
+	return reached;
+}
+
+int Wavefront::getWordsPerRow(void) const
+{
+	return wordsPerRow;
+}
+
+size_t Wavefront::getReachableCount(void) const
+{
+	size_t count = 0;
+	for (quint64 word : reached)
+	{
+		count += qPopulationCount(word);
+	}
+	return count;
+}
+
+int Wavefront::getColumn(const QPoint &p) const
+{
+	if (p.y() < 0 || p.y() >= height)
+	{
+		return -1;
+	}
+
+	int rowStart = topology == HEX_TOPOLOGY ? HexTopology::getRowStart(p.y()) : 0;
+	int column = p.x() - rowStart;
+	return column >= 0 && column < width ? column : -1;
+}
+
+
+template<class Topology>
+void Wavefront::spreadLayers(int threadCount)
+{
+	SpinBarrier barrier(threadCount);
+
+	//the first and last row of the frontier after each step, so a step only visits the rows next to the frontier. the frontier
+	//after step n is in slot n % 4. a step reads the slots of its own frontier and the one before it, which still has to be
+	//cleared out of the buffer it's writing, writes the next slot, and empties the slot after that, which nobody reads any more
+	std::atomic<int> firstRows[4];
+	std::atomic<int> lastRows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		firstRows[i].store(height, std::memory_order_relaxed);
+		lastRows[i].store(-1, std::memory_order_relaxed);
+	}
+
+	for (int row = 0; row < height; row++)
+	{
+		if (activeRows[0][row])
+		{
+			firstRows[0].store(qMin(firstRows[0].load(std::memory_order_relaxed), row), std::memory_order_relaxed);
+			lastRows[0].store(row, std::memory_order_relaxed);
+		}
+	}
+
+	auto worker = [&](int thread)
+	{
+		std::vector<quint64> candidates(markWordsPerRow);
+
+		for (int step = 0; ; step++)
+		{
+			TRACE_SCOPE("Wavefront step");
+			if (thread == 0)
+			{
+				firstRows[(step + 2) % 4].store(height, std::memory_order_relaxed);
+				lastRows[(step + 2) % 4].store(-1, std::memory_order_relaxed);
+			}
+
+			int fromRow = qMax(0, qMin(firstRows[step % 4].load(std::memory_order_relaxed) - 1, firstRows[(step + 3) % 4].load(std::memory_order_relaxed)));
+			int toRow = qMin(height - 1, qMax(lastRows[step % 4].load(std::memory_order_relaxed) + 1, lastRows[(step + 3) % 4].load(std::memory_order_relaxed)));
+
+			int firstFound = height, lastFound = -1;
+			for (int stripeStart = thread * STRIPE_ROWS; stripeStart <= toRow; stripeStart += threadCount * STRIPE_ROWS)
+			{
+				int stripeEnd = qMin(toRow + 1, stripeStart + STRIPE_ROWS);
+				for (int row = qMax(fromRow, stripeStart); row < stripeEnd; row++)
+				{
+					if (expandRow<Topology>(row, step, candidates.data()))
+					{
+						firstFound = qMin(firstFound, row);
+						lastFound = row;
+					}
+				}
+			}
+
+			if (lastFound >= 0)
+			{
+				std::atomic<int> &first = firstRows[(step + 1) % 4];
+				std::atomic<int> &last = lastRows[(step + 1) % 4];
+
+				int current = first.load(std::memory_order_relaxed);
+				while (firstFound < current && !first.compare_exchange_weak(current, firstFound, std::memory_order_relaxed))
+				{
+				}
+				current = last.load(std::memory_order_relaxed);
+				while (lastFound > current && !last.compare_exchange_weak(current, lastFound, std::memory_order_relaxed))
+				{
+				}
+			}
+			barrier.wait();
+
+			if (lastRows[(step + 1) % 4].load(std::memory_order_relaxed) < 0)
+			{
+				if (thread == 0)
+				{
+					furthestDistance = step;
+				}
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back([&worker, i]()
+		{
+			TRACE_THREAD_NAME("wavefront");
+			worker(i);
+		});
+	}
+	worker(0);
+
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+template<class Topology>
+bool Wavefront::expandRow(int row, int step, quint64 *candidates)
+{
+	const quint64 *frontier = frontiers[step % 2].data();
+	const quint64 *marks = wordMarks[step % 2].data();
+	const std::vector<quint8> &active = activeRows[step % 2];
+
+	quint64 *nextRow = frontiers[(step + 1) % 2].data() + size_t(row) * wordsPerRow;
+	quint64 *nextMarks = wordMarks[(step + 1) % 2].data() + size_t(row) * markWordsPerRow;
+	quint8 &nextActive = activeRows[(step + 1) % 2][row];
+
+	//clear out what this row held two steps ago
+	if (nextActive)
+	{
+		for (int markWord = 0; markWord < markWordsPerRow; markWord++)
+		{
+			for (quint64 bits = nextMarks[markWord]; bits != 0; bits &= bits - 1)
+			{
+				nextRow[markWord * 64 + lowestBit(bits)] = 0;
+			}
+			nextMarks[markWord] = 0;
+		}
+		nextActive = 0;
+	}
+
+	//find the frontier rows with a neighbor in this one, and how far each one moves to get here
+	//a word of this row can only gain cells if the same word or one next to it is in one of those frontiers
+	const quint64 *sources[Topology::NEIGHBOR_COUNT];
+	int shifts[Topology::NEIGHBOR_COUNT];
+	int sourceCount = 0;
+
+	std::fill(candidates, candidates + markWordsPerRow, 0);
+	for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+	{
+		int sourceRow = row - Topology::OFFSETS[direction][1];
+		if (sourceRow < 0 || sourceRow >= height || !active[sourceRow])
+		{
+			continue;
+		}
+
+		//a cell in column c of the source row moves to column c + shift of this row
+		sources[sourceCount] = frontier + size_t(sourceRow) * wordsPerRow;
+		shifts[sourceCount] = Topology::OFFSETS[direction][0] + Topology::getRowStart(sourceRow) - Topology::getRowStart(row);
+		sourceCount++;
+
+		orDilated(candidates, marks + size_t(sourceRow) * markWordsPerRow, markWordsPerRow);
+	}
+
+	if (sourceCount == 0)
+	{
+		return false;
+	}
+
+	const quint64 *passableRow = passable.data() + size_t(row) * wordsPerRow;
+	quint64 *reachedRow = reached.data() + size_t(row) * wordsPerRow;
+	int *distanceRow = distances.data() + size_t(row) * width;
+
+	bool found = false;
+	for (int markWord = 0; markWord < markWordsPerRow; markWord++)
+	{
+		for (quint64 bits = candidates[markWord]; bits != 0; bits &= bits - 1)
+		{
+			int word = markWord * 64 + lowestBit(bits);
+			if (word >= wordsPerRow)
+			{
+				break;
+			}
+
+			quint64 gathered = 0;
+			for (int i = 0; i < sourceCount; i++)
+			{
+				gathered |= shiftedWord(sources[i], word, wordsPerRow, shifts[i]);
+			}
+
+			quint64 newCells = gathered & passableRow[word] & ~reachedRow[word];
+			if (newCells == 0)
+			{
+				continue;
+			}
+
+			nextRow[word] = newCells;
+			nextMarks[markWord] |= quint64(1) << (word % 64);
+			reachedRow[word] |= newCells;
+			found = true;
+
+			for (; newCells != 0; newCells &= newCells - 1)
+			{
+				distanceRow[word * 64 + lowestBit(newCells)] = step + 1;
+			}
+		}
+	}
+
+	nextActive = found ? 1 : 0;
+	return found;
+}
+
+template<class Topology>
+void Wavefront::fill(int threadCount)
+{
+	//the rows with start cells haven't been filled along yet
+	for (int row = 0; row < height; row++)
+	{
+		if (activeRows[0][row])
+		{
+			fillRuns(reached.data() + size_t(row) * wordsPerRow, passable.data() + size_t(row) * wordsPerRow, wordsPerRow);
+		}
+	}
+
+	//each thread sweeps its own band of rows. the edge rows of the bands next to it are copied at the start of each round,
+	//so no row is read while another thread writes it, and the cells cross from one band to the next once per round
+	int bandRows = qMax(int(STRIPE_ROWS), (height + threadCount - 1) / threadCount);
+	threadCount = (height + bandRows - 1) / bandRows;
+
+	std::vector<quint64> edges(size_t(threadCount) * 2 * wordsPerRow);
+	SpinBarrier barrier(threadCount);
+
+	//how many threads changed a row in each round, see spreadLayers
+	std::atomic<int> changedCounts[3];
+	for (std::atomic<int> &count : changedCounts)
+	{
+		count.store(0, std::memory_order_relaxed);
+	}
+
+	auto worker = [&](int thread)
+	{
+		int firstRow = thread * bandRows;
+		int lastRow = qMin(height, firstRow + bandRows) - 1;
+
+		quint64 *firstEdge = edges.data() + size_t(thread) * 2 * wordsPerRow;
+		quint64 *lastEdge = firstEdge + wordsPerRow;
+		const quint64 *edgeAbove = thread > 0 ? firstEdge - wordsPerRow : nullptr;
+		const quint64 *edgeBelow = thread + 1 < threadCount ? lastEdge + wordsPerRow : nullptr;
+
+		auto getRow = [&](int row) -> const quint64*
+		{
+			if (row < firstRow)
+				return edgeAbove;
+			if (row > lastRow)
+				return edgeBelow;
+			return reached.data() + size_t(row) * wordsPerRow;
+		};
+
+		for (int round = 0; ; round++)
+		{
+			TRACE_SCOPE("Wavefront round");
+			if (thread == 0)
+			{
+				changedCounts[(round + 1) % 3].store(0, std::memory_order_relaxed);
+			}
+
+			std::copy_n(reached.data() + size_t(firstRow) * wordsPerRow, wordsPerRow, firstEdge);
+			std::copy_n(reached.data() + size_t(lastRow) * wordsPerRow, wordsPerRow, lastEdge);
+			barrier.wait();
+
+			bool changed = false;
+			for (int row = firstRow; row <= lastRow; row++)
+			{
+				changed |= fillRow<Topology>(row, getRow(row - 1), getRow(row + 1));
+			}
+			for (int row = lastRow; row >= firstRow; row--)
+			{
+				changed |= fillRow<Topology>(row, getRow(row - 1), getRow(row + 1));
+			}
+
+			if (changed)
+			{
+				changedCounts[round % 3].fetch_add(1, std::memory_order_relaxed);
+			}
+			barrier.wait();
+
+			if (changedCounts[round % 3].load(std::memory_order_relaxed) == 0)
+			{
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back([&worker, i]()
+		{
+			TRACE_THREAD_NAME("wavefront");
+			worker(i);
+		});
+	}
+	worker(0);
+
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+template<class Topology>
+bool Wavefront::fillRow(int row, const quint64 *above, const quint64 *below)
+{
+	//every topology's moves within a row are one column left or right, which filling the runs already covers
+	//so only the moves from the rows above and below are gathered here
+	const quint64 *sources[Topology::NEIGHBOR_COUNT];
+	int shifts[Topology::NEIGHBOR_COUNT];
+	int sourceCount = 0;
+
+	for (int direction = 0; direction < Topology::NEIGHBOR_COUNT; direction++)
+	{
+		int sourceRow = row - Topology::OFFSETS[direction][1];
+		const quint64 *source = sourceRow < row ? above : below;
+		if (sourceRow == row || source == nullptr)
+		{
+			continue;
+		}
+
+		sources[sourceCount] = source;
+		shifts[sourceCount] = Topology::OFFSETS[direction][0] + Topology::getRowStart(sourceRow) - Topology::getRowStart(row);
+		sourceCount++;
+	}
+
+	const quint64 *passableRow = passable.data() + size_t(row) * wordsPerRow;
+	quint64 *reachedRow = reached.data() + size_t(row) * wordsPerRow;
+
+	bool seeded = false;
+	for (int word = 0; word < wordsPerRow; word++)
+	{
+		quint64 gathered = 0;
+		for (int i = 0; i < sourceCount; i++)
+		{
+			gathered |= shiftedWord(sources[i], word, wordsPerRow, shifts[i]);
+		}
+
+		quint64 newCells = gathered & passableRow[word] & ~reachedRow[word];
+		if (newCells != 0)
+		{
+			reachedRow[word] |= newCells;
+			seeded = true;
+		}
+	}
+
+	//a row that was already filled and gained nothing is still filled
+	if (seeded)
+	{
+		fillRuns(reachedRow, passableRow, wordsPerRow);
+	}
+	return seeded;
+}
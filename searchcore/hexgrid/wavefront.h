@@ -0,0 +1,93 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <QPoint>
+#include <QtGlobal>
+
+#include <vector>
+
+#include "hexgrid/gridtopology.h"
+
+class HexGrid;
+
+//a breadth first search over the whole grid that moves 64 cells at a time instead of one
+//every move costs 1, so the cells reached after n steps are exactly the cells n moves from the closest start cell, and no open set is needed
+//each row is a bitset with one bit per column, in the same skewed layout HexGrid stores its cells in. moving the frontier is a shift
+//of the rows next to it, one column for each direction, masked by the open cells that haven't been reached yet
+//rows are split between threads, which wait for each other between steps
+class Wavefront
+{
+public:
+	//DISTANCES finds how many moves away each cell is, one layer per step
+	//REACHABILITY only finds which cells can be reached. it doesn't need the layers, so it fills every open run of a row in one go
+	//and sweeps down and up the rows until nothing changes, which takes a handful of sweeps unless the map is a maze
+	enum Output { REACHABILITY, DISTANCES };
+
+	//copies the walls out of the grid. later changes to the grid aren't seen
+	explicit Wavefront(const HexGrid &grid);
+
+	//spreads out from the given cells until no new cells are reached. start cells that are walls or aren't valid are skipped
+	//with a thread count of 0, one thread is used per core. returns false if none of the start cells could be used
+	bool run(const std::vector<QPoint> &startStates, Output output = DISTANCES, int threadCount = 0);
+
+	//the results of the last run
+	bool isReachable(const QPoint &p) const;
+
+	//-1 if the cell can't be reached, or if the last run only asked for REACHABILITY
+	int getDistance(const QPoint &p) const;
+
+	//the distance to every cell, indexed by HexGrid::getIndex. empty if the last run only asked for REACHABILITY
+	const std::vector<int>& getDistances(void) const;
+
+	//the distance to the furthest cell that was reached, or -1 if the last run only asked for REACHABILITY
+	int getFurthestDistance(void) const;
+
+	//the cells reached by the last run, one bitset per row. the cell in a given column of a given row
+	//is bit (column % 64) of word (row * getWordsPerRow() + column / 64). see HexGrid::toCell for what a column is
+	const std::vector<quint64>& getReachableMask(void) const;
+	int getWordsPerRow(void) const;
+
+	size_t getReachableCount(void) const;
+
+private:
+	//when finding distances, rows are dealt out to threads this many at a time, so the work is shared evenly wherever the frontier is
+	//when filling, each thread gets one band of rows, and no band is smaller than this
+	static const int STRIPE_ROWS = 16;
+
+	//the column of p within its row, or -1 if p isn't a valid cell
+	int getColumn(const QPoint &p) const;
+
+	template<class Topology>
+	void spreadLayers(int threadCount);
+
+	//works out which cells of the given row join the frontier in this step. returns true if there were any
+	template<class Topology>
+	bool expandRow(int row, int step, quint64 *candidates);
+
+	template<class Topology>
+	void fill(int threadCount);
+
+	//adds everything the rows above and below reach into the given row, and fills the open runs it lands in
+	//either neighbor row can be null. returns true if the row changed
+	template<class Topology>
+	bool fillRow(int row, const quint64 *above, const quint64 *below);
+
+	int width, height;
+	int wordsPerRow;
+	GridTopology topology;
+
+	std::vector<quint64> passable;
+	std::vector<quint64> reached;
+
+	//the frontier before and after each step, which swap roles every step. wordMarks has a bit for every word of
+	//the frontier that isn't zero, (wordsPerRow + 63) / 64 words of them per row, so a step only looks at the words next to the frontier
+	std::vector<quint64> frontiers[2];
+	std::vector<quint64> wordMarks[2];
+	std::vector<quint8> activeRows[2];
+	int markWordsPerRow;
+
+	std::vector<int> distances;
+	int furthestDistance;
+};
+
+#endif // WAVEFRONT_H
@@ -0,0 +1,15 @@
+# include this from a project that links against the searchcore static library
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CONFIG(tracing): DEFINES += SEARCH_TRACING
+
+win32:CONFIG(release, debug|release): SEARCHCORE_LIB_DIR = $$OUT_PWD/../searchcore/release
+else:win32:CONFIG(debug, debug|release): SEARCHCORE_LIB_DIR = $$OUT_PWD/../searchcore/debug
+else: SEARCHCORE_LIB_DIR = $$OUT_PWD/../searchcore
+
+LIBS += -L$$SEARCHCORE_LIB_DIR -lsearchcore
+
+win32-msvc*: PRE_TARGETDEPS += $$SEARCHCORE_LIB_DIR/searchcore.lib
+else: PRE_TARGETDEPS += $$SEARCHCORE_LIB_DIR/libsearchcore.a
@@ -0,0 +1,57 @@
+QT       += core
+QT       -= gui
+
+TARGET = searchcore
+TEMPLATE = lib
+
+CONFIG += c++11 staticlib
+
+# build with CONFIG+=tracing to compile in the TRACE_ markers, see utils/traceevents.h
+CONFIG(tracing): DEFINES += SEARCH_TRACING
+
+# build with CONFIG+=simd to compare the heuristic against 8 goals at once, see hexgrid/goaldistance.h
+# the binary then needs a CPU with AVX2
+CONFIG(simd) {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2
+}
+
+
+SOURCES += \
+    hexgrid/gridsearchevent.cpp \
+    hexgrid/hexgrid.cpp \
+    hexgrid/gridtopology.cpp \
+    hexgrid/gridsearcher.cpp \
+    hexgrid/gridloader.cpp \
+    hexgrid/movingaiimporter.cpp \
+    hexgrid/searchtrace.cpp \
+    hexgrid/searchservice.cpp \
+    hexgrid/wavefront.cpp \
+    hexgrid/cooperativeplanner.cpp \
+    hexgrid/pathdatabase.cpp \
+    utils/traceevents.cpp
+
+HEADERS  += \
+    hexgrid/gridsearchevent.h \
+    hexgrid/hexgrid.h \
+    hexgrid/gridtopology.h \
+    hexgrid/goaldistance.h \
+    hexgrid/gridsearcher.h \
+    hexgrid/gridloader.h \
+    hexgrid/movingaiimporter.h \
+    hexgrid/searchtrace.h \
+    hexgrid/searchservice.h \
+    hexgrid/wavefront.h \
+    hexgrid/cooperativeplanner.h \
+    hexgrid/pathdatabase.h \
+    utils/channel.h \
+    utils/spscchannel.h \
+    utils/channelsignal.h \
+    utils/channelmetrics.h \
+    utils/channelmultiplexer.h \
+    utils/cancellationtoken.h \
+    utils/poolallocator.h \
+    utils/traceevents.h \
+    utils/littleendian.h \
+    algorithms/searchalgorithms.h \
+    algorithms/searchobservers.h
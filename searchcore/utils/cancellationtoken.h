@@ -0,0 +1,36 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <memory>
+
+//a handle to a shared "please stop" flag. copies share the same flag, so the copy given to a search can be cancelled from anywhere else
+//cancelling is a request, not a guarantee. the search checks the flag between expansions
+class CancellationToken
+{
+public:
+	CancellationToken(void)
+		:cancelled(std::make_shared<std::atomic<bool>>(false))
+	{}
+
+	void cancel(void)
+	{
+		cancelled->store(true, std::memory_order_relaxed);
+	}
+
+	bool isCancelled(void) const
+	{
+		return cancelled->load(std::memory_order_relaxed);
+	}
+
+	//for loops that check the flag often enough that they want to skip the extra indirection
+	const std::atomic<bool> *getFlag(void) const
+	{
+		return cancelled.get();
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,425 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <vector>
+#include <limits>
+#include <utility>
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "utils/channelmetrics.h"
+#include "utils/channelsignal.h"
+#include "utils/traceevents.h"
+
+template<class T>
+class Channel
+{
+public:
+	enum FullPushBehavior { BLOCK, DROP_NEWEST, DROP_OLDEST, NEVER_FULL };
+	Channel(void);
+	Channel(FullPushBehavior fullPushBehavior, size_t maxSize = 1);
+	Channel(const Channel &other) = delete;
+
+	//closing the front of the channel will cause all pushes into the channel to return false, permenently
+	//use it when a consumer wants to inform producers that nothing else will be consumed from the channel
+	bool isFrontClosed(void) const;
+	void closeFront(void);
+
+	//closing the back of the channel will cause all pops from the channel to return false, permenently
+	//use it when a producer wants to inform consumers that nothing else will be produced into the channel
+	bool isBackClosed(void) const;
+	void closeBack(void);
+
+	//put an item in the channel. returns false if the front of the channel was closed.
+	bool push(const T& item);
+	bool push(T&& item);
+
+	//construct an item in place at the back of the channel. returns false if the front of the channel was closed.
+	template<class... Args>
+	bool emplace(Args&&... args);
+
+	//put every item in the range into the channel, taking the lock once for the whole range instead of once per item
+	//pass move iterators to move the items in. returns false if the front of the channel was closed.
+	template<class InputIterator>
+	bool pushMany(InputIterator first, InputIterator last);
+
+	//get an item from the channel and place it in 'result'. if the channel is empty, block until something is added or until the back is closed
+	//returns false when because the channel is empty and the back is closed
+	bool pop(T& result);
+
+	//move up to maxItems items from the channel onto the end of 'results', under a single lock. if the channel is empty, block like pop()
+	//returns the number of items added, which is only 0 when the channel is empty and the back is closed
+	size_t popMany(std::vector<T>& results, size_t maxItems);
+
+	//same as popMany, but takes everything that's in the channel
+	size_t popAll(std::vector<T>& results);
+
+	//move everything that's currently in the channel onto the end of 'results' without blocking. returns the number of items added
+	size_t tryPopAll(std::vector<T>& results);
+
+	//notify the given signal whenever items are added or the back is closed, so one consumer can wait on several channels at once
+	//set it before anything is pushed into the channel
+	void setSignal(std::shared_ptr<ChannelSignal> signal);
+
+	//start counting pushes, pops, drops and waits. call it before anything is pushed into the channel
+	void enableMetrics(void);
+
+	//a copy of the counts so far, which is all zeros unless enableMetrics was called. safe to call from any thread
+	ChannelMetrics::Snapshot getMetrics(void) const;
+
+private:
+	//applies the full push behavior to make room for one more item. the queue mutex must be held by 'locker'
+	//returns false if the item shouldn't be added, either because it's being dropped or because the front was closed
+	bool makeRoom(std::unique_lock<std::mutex> &locker);
+
+	//wake up anyone who might be waiting for items, including a consumer waiting on the signal
+	void notifyConsumers(bool all);
+
+	const FullPushBehavior fullPushBehavior;
+	const size_t maxSize;
+	std::atomic<bool> _isFrontClosed;
+	std::atomic<bool> _isBackClosed;
+
+	std::queue<T> queue;
+	std::mutex queueMutex;
+	std::condition_variable fullWait;
+	std::condition_variable emptyWait;
+
+	std::shared_ptr<ChannelSignal> signal;
+
+	//null unless metrics are enabled, so a channel without them only pays for the null checks
+	std::unique_ptr<ChannelMetrics> metrics;
+};
+
+class ChannelClosedException : public std::exception
+{
+
+};
+
+template<class T>
+Channel<T>::Channel(void)
+	:fullPushBehavior(NEVER_FULL), maxSize(0), _isFrontClosed(false), _isBackClosed(false)
+{
+
+}
+
+template<class T>
+Channel<T>::Channel(FullPushBehavior fullPushBehavior, size_t maxSize)
+	:fullPushBehavior(fullPushBehavior), maxSize(maxSize), _isFrontClosed(false), _isBackClosed(false)
+{
+	if (fullPushBehavior != NEVER_FULL)
+		assert(maxSize > 0);
+}
+
+template<class T>
+bool Channel<T>::isFrontClosed(void) const
+{
+	return _isFrontClosed.load(std::memory_order_acquire);
+}
+
+template<class T>
+void Channel<T>::closeFront(void)
+{
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	_isFrontClosed.store(true, std::memory_order_release);
+
+	//if anyone is waiting for the "full" condition variable, wake them up so that they know they should stop pushing data
+	fullWait.notify_all();
+}
+
+template<class T>
+bool Channel<T>::isBackClosed(void) const
+{
+	return _isBackClosed.load(std::memory_order_acquire);
+}
+
+template<class T>
+void Channel<T>::closeBack(void)
+{
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	_isBackClosed.store(true, std::memory_order_release);
+
+	//if anyone is waiting for the "empty" condition variable, wake them up so that they know they're not going to get any more data
+	notifyConsumers(true);
+}
+
+template<class T>
+bool Channel<T>::push(const T& item)
+{
+	return emplace(item);
+}
+
+template<class T>
+bool Channel<T>::push(T&& item)
+{
+	return emplace(std::move(item));
+}
+
+template<class T>
+template<class... Args>
+bool Channel<T>::emplace(Args&&... args)
+{
+	if (isBackClosed())
+	{
+		throw ChannelClosedException();
+	}
+
+
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	if (isFrontClosed())
+	{
+		return false;
+	}
+
+	if (makeRoom(locker))
+	{
+		queue.emplace(std::forward<Args>(args)...);
+
+		if (metrics != nullptr)
+		{
+			metrics->addPushes(1);
+			metrics->recordDepth(queue.size());
+		}
+
+		//wake up anyone who might be waiting
+		notifyConsumers(false);
+	}
+
+	return !isFrontClosed();
+}
+
+template<class T>
+template<class InputIterator>
+bool Channel<T>::pushMany(InputIterator first, InputIterator last)
+{
+	if (isBackClosed())
+	{
+		throw ChannelClosedException();
+	}
+
+
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	size_t pushed = 0;
+	for (; first != last; ++first)
+	{
+		if (isFrontClosed())
+		{
+			break;
+		}
+
+		if (makeRoom(locker))
+		{
+			queue.push(*first);
+			pushed++;
+		}
+	}
+
+	if (metrics != nullptr)
+	{
+		metrics->addPushes(pushed);
+		metrics->recordDepth(queue.size());
+	}
+
+	//wake up anyone who might be waiting. one wakeup covers the whole batch, since the consumer can take all of it at once
+	notifyConsumers(true);
+
+	return !isFrontClosed();
+}
+
+template<class T>
+bool Channel<T>::makeRoom(std::unique_lock<std::mutex> &locker)
+{
+	if (fullPushBehavior == NEVER_FULL || queue.size() < maxSize)
+	{
+		return true;
+	}
+
+	if (fullPushBehavior == BLOCK)
+	{
+		//if we're in the middle of a batch, the consumer may not know about the items we've already added, so wake it up before we block
+		notifyConsumers(false);
+
+		//block until the queue isn't full anymore
+		TRACE_SCOPE("Channel push wait");
+		auto waitStart = std::chrono::steady_clock::now();
+		fullWait.wait(locker, [this]() { return isFrontClosed() || queue.size() < maxSize; });
+
+		if (metrics != nullptr)
+		{
+			metrics->addProducerWait(std::chrono::steady_clock::now() - waitStart);
+		}
+
+		return !isFrontClosed();
+	}
+	else if (fullPushBehavior == DROP_NEWEST)
+	{
+		//if the queue is full, we're just going to drop the given item
+		if (metrics != nullptr)
+		{
+			metrics->addDrops(1);
+		}
+		return false;
+	}
+	else
+	{
+		//DROP_OLDEST: if the queue is full, pop off the front of the channel
+		queue.pop();
+
+		if (metrics != nullptr)
+		{
+			metrics->addDrops(1);
+		}
+		return true;
+	}
+}
+
+template<class T>
+bool Channel<T>::pop(T& result)
+{
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	//if the queue is closed and empty, return false to iindicate that the caller will not recieve a response
+	if (isBackClosed() && queue.empty())
+		return false;
+
+	//if the queue is empty, block!
+	if (queue.empty())
+	{
+		TRACE_SCOPE("Channel pop wait");
+		auto waitStart = std::chrono::steady_clock::now();
+		emptyWait.wait(locker, [this]() { return isBackClosed() || !queue.empty(); });
+
+		if (metrics != nullptr)
+		{
+			metrics->addConsumerWait(std::chrono::steady_clock::now() - waitStart);
+		}
+
+		//if the queue is still empty, it means it's closed and will never get another item,so return false
+		if (queue.empty())
+			return false;
+	}
+
+	result = std::move(queue.front());
+	queue.pop();
+
+	if (metrics != nullptr)
+	{
+		metrics->addPops(1);
+	}
+
+	//notify any pushers who may be waiting on a full queue that it is no longer empty
+	fullWait.notify_one();
+	return true;
+}
+
+template<class T>
+size_t Channel<T>::popMany(std::vector<T>& results, size_t maxItems)
+{
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	//if the queue is empty, block!
+	if (queue.empty())
+	{
+		TRACE_SCOPE("Channel pop wait");
+		auto waitStart = std::chrono::steady_clock::now();
+		emptyWait.wait(locker, [this]() { return isBackClosed() || !queue.empty(); });
+
+		if (metrics != nullptr)
+		{
+			metrics->addConsumerWait(std::chrono::steady_clock::now() - waitStart);
+		}
+	}
+
+	size_t count = 0;
+	for (; count < maxItems && !queue.empty(); count++)
+	{
+		results.push_back(std::move(queue.front()));
+		queue.pop();
+	}
+
+	if (metrics != nullptr)
+	{
+		metrics->addPops(count);
+	}
+
+	//we may have freed up several spots, so notify all the pushers who may be waiting on a full queue
+	if (count > 0)
+	{
+		fullWait.notify_all();
+	}
+	return count;
+}
+
+template<class T>
+size_t Channel<T>::popAll(std::vector<T>& results)
+{
+	return popMany(results, std::numeric_limits<size_t>::max());
+}
+
+template<class T>
+size_t Channel<T>::tryPopAll(std::vector<T>& results)
+{
+	std::unique_lock<std::mutex> locker(queueMutex);
+
+	size_t count = 0;
+	for (; !queue.empty(); count++)
+	{
+		results.push_back(std::move(queue.front()));
+		queue.pop();
+	}
+
+	if (metrics != nullptr)
+	{
+		metrics->addPops(count);
+	}
+
+	if (count > 0)
+	{
+		fullWait.notify_all();
+	}
+	return count;
+}
+
+template<class T>
+void Channel<T>::setSignal(std::shared_ptr<ChannelSignal> s)
+{
+	signal = s;
+}
+
+template<class T>
+void Channel<T>::enableMetrics(void)
+{
+	metrics.reset(new ChannelMetrics());
+}
+
+template<class T>
+ChannelMetrics::Snapshot Channel<T>::getMetrics(void) const
+{
+	return metrics != nullptr ? metrics->getSnapshot() : ChannelMetrics::Snapshot();
+}
+
+template<class T>
+void Channel<T>::notifyConsumers(bool all)
+{
+	if (all)
+		emptyWait.notify_all();
+	else
+		emptyWait.notify_one();
+
+	if (signal != nullptr)
+	{
+		signal->notify();
+	}
+}
+
+#endif // CHANNEL_H
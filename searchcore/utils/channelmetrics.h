@@ -0,0 +1,134 @@
+#ifndef CHANNELMETRICS_H
+#define CHANNELMETRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+//counts what happens to a channel, so channel sizes and full push behaviors can be picked from data instead of guesses
+//channels only keep metrics when enableMetrics() is called on them. every counter is a relaxed atomic,
+//so a snapshot can be taken from any thread while the channel is in use, but the counters may be a moment apart from each other
+class ChannelMetrics
+{
+public:
+	//bucket i of a wait histogram counts the waits that took less than 2^i microseconds, and more than the bucket before it
+	//the last bucket also counts everything longer
+	static const int HISTOGRAM_BUCKETS = 24;
+	typedef std::array<size_t, HISTOGRAM_BUCKETS> Histogram;
+
+	//a copy of the counters at one moment
+	struct Snapshot
+	{
+		size_t pushes;
+		size_t pops;
+
+		//items thrown away by DROP_NEWEST or DROP_OLDEST
+		size_t drops;
+
+		//the most items the channel has held at once
+		size_t highWaterMark;
+
+		//how often, and for how long, a producer waited for room and a consumer waited for items
+		size_t producerWaits;
+		size_t consumerWaits;
+		std::chrono::nanoseconds producerWaitTime;
+		std::chrono::nanoseconds consumerWaitTime;
+		Histogram producerWaitHistogram;
+		Histogram consumerWaitHistogram;
+
+		Snapshot(void)
+			:pushes(0), pops(0), drops(0), highWaterMark(0), producerWaits(0), consumerWaits(0),
+			producerWaitTime(0), consumerWaitTime(0), producerWaitHistogram(), consumerWaitHistogram()
+		{}
+	};
+
+	ChannelMetrics(void)
+		:pushes(0), pops(0), drops(0), highWaterMark(0), producerWaits(0), consumerWaits(0), producerWaitNanoseconds(0), consumerWaitNanoseconds(0)
+	{
+		for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		{
+			producerWaitHistogram[i].store(0, std::memory_order_relaxed);
+			consumerWaitHistogram[i].store(0, std::memory_order_relaxed);
+		}
+	}
+	ChannelMetrics(const ChannelMetrics &other) = delete;
+
+	void addPushes(size_t count) { pushes.fetch_add(count, std::memory_order_relaxed); }
+	void addPops(size_t count) { pops.fetch_add(count, std::memory_order_relaxed); }
+	void addDrops(size_t count) { drops.fetch_add(count, std::memory_order_relaxed); }
+
+	//call after adding items, with the number of items the channel holds now
+	void recordDepth(size_t depth)
+	{
+		//the high water mark rarely changes, so only pay for the compare and swap when it does
+		size_t current = highWaterMark.load(std::memory_order_relaxed);
+		while (depth > current && !highWaterMark.compare_exchange_weak(current, depth, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void addProducerWait(std::chrono::nanoseconds duration)
+	{
+		addWait(duration, producerWaits, producerWaitNanoseconds, producerWaitHistogram);
+	}
+
+	void addConsumerWait(std::chrono::nanoseconds duration)
+	{
+		addWait(duration, consumerWaits, consumerWaitNanoseconds, consumerWaitHistogram);
+	}
+
+	Snapshot getSnapshot(void) const
+	{
+		Snapshot snapshot;
+		snapshot.pushes = pushes.load(std::memory_order_relaxed);
+		snapshot.pops = pops.load(std::memory_order_relaxed);
+		snapshot.drops = drops.load(std::memory_order_relaxed);
+		snapshot.highWaterMark = highWaterMark.load(std::memory_order_relaxed);
+		snapshot.producerWaits = producerWaits.load(std::memory_order_relaxed);
+		snapshot.consumerWaits = consumerWaits.load(std::memory_order_relaxed);
+		snapshot.producerWaitTime = std::chrono::nanoseconds(producerWaitNanoseconds.load(std::memory_order_relaxed));
+		snapshot.consumerWaitTime = std::chrono::nanoseconds(consumerWaitNanoseconds.load(std::memory_order_relaxed));
+		for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		{
+			snapshot.producerWaitHistogram[i] = producerWaitHistogram[i].load(std::memory_order_relaxed);
+			snapshot.consumerWaitHistogram[i] = consumerWaitHistogram[i].load(std::memory_order_relaxed);
+		}
+		return snapshot;
+	}
+
+	//the index of the histogram bucket a wait of the given length goes in
+	static int getBucket(std::chrono::nanoseconds duration)
+	{
+		long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+		int bucket = 0;
+		while (bucket < HISTOGRAM_BUCKETS - 1 && microseconds >= (1LL << bucket))
+		{
+			bucket++;
+		}
+		return bucket;
+	}
+
+private:
+	static void addWait(std::chrono::nanoseconds duration, std::atomic<size_t> &count, std::atomic<long long> &total,
+		std::atomic<size_t> *histogram)
+	{
+		count.fetch_add(1, std::memory_order_relaxed);
+		total.fetch_add(duration.count(), std::memory_order_relaxed);
+		histogram[getBucket(duration)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::atomic<size_t> pushes;
+	std::atomic<size_t> pops;
+	std::atomic<size_t> drops;
+	std::atomic<size_t> highWaterMark;
+
+	std::atomic<size_t> producerWaits;
+	std::atomic<size_t> consumerWaits;
+	std::atomic<long long> producerWaitNanoseconds;
+	std::atomic<long long> consumerWaitNanoseconds;
+	std::atomic<size_t> producerWaitHistogram[HISTOGRAM_BUCKETS];
+	std::atomic<size_t> consumerWaitHistogram[HISTOGRAM_BUCKETS];
+};
+
+#endif // CHANNELMETRICS_H
@@ -0,0 +1,147 @@
+#ifndef CHANNELMULTIPLEXER_H
+#define CHANNELMULTIPLEXER_H
+
+#include <memory>
+#include <vector>
+
+#include "utils/channelsignal.h"
+
+//merges the output of several channels into one consumer, like select() does for sockets
+//works with any channel that has tryPopAll, isBackClosed and setSignal, ie Channel and SpscChannel
+//only one thread may consume from the multiplexer, and nothing else may pop from the channels it holds
+template<class T, class ChannelType>
+class ChannelMultiplexer
+{
+public:
+	ChannelMultiplexer(void);
+	ChannelMultiplexer(const ChannelMultiplexer &other) = delete;
+
+	//start watching a channel. the channel's signal is replaced with the multiplexer's, so add it before anything is pushed into it
+	//returns the index the channel's items will be reported under
+	size_t add(std::shared_ptr<ChannelType> channel);
+	size_t size(void) const;
+
+	//wait until at least one channel has items, then move everything from one of them onto the end of 'results'
+	//channels take turns, so a busy channel can't starve the others. returns the index of the channel the items came from,
+	//or -1 once every channel is empty and has had its back closed
+	int select(std::vector<T>& results);
+
+	//without blocking, move everything from every channel onto the end of its vector in 'results', which is resized to size()
+	//returns the total number of items added
+	size_t trySelectAll(std::vector<std::vector<T>>& results);
+
+	//true once a channel is empty and has had its back closed. it won't produce anything else
+	bool isFinished(size_t index) const;
+	bool isFinished(void) const;
+
+private:
+	//move everything out of one channel, and mark it finished if it's empty and closed
+	size_t drain(size_t index, std::vector<T>& results);
+
+	std::shared_ptr<ChannelSignal> signal;
+
+	std::vector<std::shared_ptr<ChannelType>> channels;
+	std::vector<bool> finished;
+	size_t finishedCount;
+
+	//the channel select() looks at first next time
+	size_t nextChannel;
+};
+
+template<class T, class ChannelType>
+ChannelMultiplexer<T, ChannelType>::ChannelMultiplexer(void)
+	:signal(std::make_shared<ChannelSignal>()), finishedCount(0), nextChannel(0)
+{
+}
+
+template<class T, class ChannelType>
+size_t ChannelMultiplexer<T, ChannelType>::add(std::shared_ptr<ChannelType> channel)
+{
+	channel->setSignal(signal);
+
+	channels.push_back(channel);
+	finished.push_back(false);
+	return channels.size() - 1;
+}
+
+template<class T, class ChannelType>
+size_t ChannelMultiplexer<T, ChannelType>::size(void) const
+{
+	return channels.size();
+}
+
+template<class T, class ChannelType>
+int ChannelMultiplexer<T, ChannelType>::select(std::vector<T>& results)
+{
+	while (!isFinished())
+	{
+		//read the generation before looking at the channels, so anything pushed after we look wakes us up
+		size_t seenGeneration = signal->getGeneration();
+
+		for (size_t i = 0; i < channels.size(); i++)
+		{
+			size_t index = (nextChannel + i) % channels.size();
+			if (!finished[index] && drain(index, results) > 0)
+			{
+				nextChannel = index + 1;
+				return int(index);
+			}
+		}
+
+		if (!isFinished())
+		{
+			signal->wait(seenGeneration);
+		}
+	}
+	return -1;
+}
+
+template<class T, class ChannelType>
+size_t ChannelMultiplexer<T, ChannelType>::trySelectAll(std::vector<std::vector<T>>& results)
+{
+	results.resize(channels.size());
+
+	size_t count = 0;
+	for (size_t i = 0; i < channels.size(); i++)
+	{
+		if (!finished[i])
+		{
+			count += drain(i, results[i]);
+		}
+	}
+	return count;
+}
+
+template<class T, class ChannelType>
+bool ChannelMultiplexer<T, ChannelType>::isFinished(size_t index) const
+{
+	return finished[index];
+}
+
+template<class T, class ChannelType>
+bool ChannelMultiplexer<T, ChannelType>::isFinished(void) const
+{
+	return finishedCount == channels.size();
+}
+
+template<class T, class ChannelType>
+size_t ChannelMultiplexer<T, ChannelType>::drain(size_t index, std::vector<T>& results)
+{
+	ChannelType &channel = *channels[index];
+
+	size_t count = channel.tryPopAll(results);
+
+	//the back is only closed after the last push, so if it's closed, one more look is guaranteed to find anything that's left
+	if (count == 0 && channel.isBackClosed())
+	{
+		count = channel.tryPopAll(results);
+		if (count == 0)
+		{
+			finished[index] = true;
+			finishedCount++;
+		}
+	}
+	return count;
+}
+
+#endif // CHANNELMULTIPLEXER_H
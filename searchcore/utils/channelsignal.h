@@ -0,0 +1,54 @@
+#ifndef CHANNELSIGNAL_H
+#define CHANNELSIGNAL_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+//lets one consumer sleep until something happens in any of several channels
+//every channel the signal is attached to calls notify() after it adds items or has its back closed
+class ChannelSignal
+{
+public:
+	ChannelSignal(void)
+		:generation(0), waiting(false)
+	{}
+	ChannelSignal(const ChannelSignal &other) = delete;
+
+	//the number of notifications so far. read it before checking the channels, then pass it to wait()
+	size_t getGeneration(void) const
+	{
+		return generation.load(std::memory_order_seq_cst);
+	}
+
+	//block until notify() has been called since 'seenGeneration' was read. only one thread may wait at a time
+	void wait(size_t seenGeneration)
+	{
+		std::unique_lock<std::mutex> locker(waitMutex);
+
+		//pairs with notify: either we see the new generation, or it sees that we're waiting
+		waiting.store(true, std::memory_order_seq_cst);
+		changed.wait(locker, [this, seenGeneration]() { return generation.load(std::memory_order_seq_cst) != seenGeneration; });
+		waiting.store(false, std::memory_order_relaxed);
+	}
+
+	//producers only pay for the atomic increment unless the consumer is actually asleep
+	void notify(void)
+	{
+		generation.fetch_add(1, std::memory_order_seq_cst);
+		if (waiting.load(std::memory_order_seq_cst))
+		{
+			std::unique_lock<std::mutex> locker(waitMutex);
+			changed.notify_all();
+		}
+	}
+
+private:
+	std::atomic<size_t> generation;
+	std::atomic<bool> waiting;
+
+	std::mutex waitMutex;
+	std::condition_variable changed;
+};
+
+#endif // CHANNELSIGNAL_H
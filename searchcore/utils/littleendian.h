@@ -0,0 +1,29 @@
+#ifndef LITTLEENDIAN_H
+#define LITTLEENDIAN_H
+
+#include <QByteArray>
+
+//helpers for the binary file formats, which store every integer little endian whatever the platform is
+
+template<class T>
+void appendLittleEndian(QByteArray &bytes, T value)
+{
+	for (size_t i = 0; i < sizeof(T); i++)
+	{
+		bytes.append(char(value & 0xff));
+		value >>= 8;
+	}
+}
+
+template<class T>
+T readLittleEndian(const uchar *p)
+{
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); i++)
+	{
+		value |= T(p[i]) << (8 * i);
+	}
+	return value;
+}
+
+#endif // LITTLEENDIAN_H
@@ -0,0 +1,187 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//hands out small fixed size blocks carved from big chunks, and keeps every freed block on a free list to be handed out again
+//nothing is given back to the system until the pool is destroyed, so a container that's cleared and refilled stops allocating
+//not thread safe. give each thread its own pool
+class MemoryPool
+{
+public:
+	MemoryPool(void)
+		:currentChunk(0), chunkPosition(nullptr), chunkEnd(nullptr)
+	{}
+	MemoryPool(const MemoryPool &other) = delete;
+
+	~MemoryPool(void)
+	{
+		for (char *chunk : chunks)
+		{
+			::operator delete(chunk);
+		}
+	}
+
+	void *allocate(size_t size)
+	{
+		size = roundUp(size);
+		if (size > MAX_BLOCK_SIZE)
+		{
+			return ::operator new(size);
+		}
+
+		FreeList &freeList = getFreeList(size);
+		if (freeList.head != nullptr)
+		{
+			FreeBlock *block = freeList.head;
+			freeList.head = block->next;
+			return block;
+		}
+
+		if (chunkPosition == nullptr || size_t(chunkEnd - chunkPosition) < size)
+		{
+			//whatever is left of the old chunk is too small for this block, and isn't worth keeping track of
+			if (chunkPosition != nullptr)
+				currentChunk++;
+
+			if (currentChunk == chunks.size())
+				chunks.push_back(static_cast<char*>(::operator new(CHUNK_SIZE)));
+
+			chunkPosition = chunks[currentChunk];
+			chunkEnd = chunkPosition + CHUNK_SIZE;
+		}
+
+		void *result = chunkPosition;
+		chunkPosition += size;
+		return result;
+	}
+
+	void deallocate(void *p, size_t size)
+	{
+		size = roundUp(size);
+		if (size > MAX_BLOCK_SIZE)
+		{
+			::operator delete(p);
+			return;
+		}
+
+		FreeList &freeList = getFreeList(size);
+		FreeBlock *block = static_cast<FreeBlock*>(p);
+		block->next = freeList.head;
+		freeList.head = block;
+	}
+
+	//forget every block at once, and start handing out memory from the beginning of the first chunk again
+	//only call this when nothing allocated from the pool is in use anymore. unlike the free lists,
+	//this hands blocks out in address order again, which keeps a refilled container's nodes close together
+	void reset(void)
+	{
+		freeLists.clear();
+		currentChunk = 0;
+		chunkPosition = chunks.empty() ? nullptr : chunks[0];
+		chunkEnd = chunks.empty() ? nullptr : chunks[0] + CHUNK_SIZE;
+	}
+
+private:
+	static const size_t CHUNK_SIZE = 64 * 1024;
+	static const size_t MAX_BLOCK_SIZE = 1024;
+	static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+	struct FreeBlock
+	{
+		FreeBlock *next;
+	};
+
+	struct FreeList
+	{
+		size_t size;
+		FreeBlock *head;
+	};
+
+	static size_t roundUp(size_t size)
+	{
+		size = size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+		return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+
+	//containers only ever ask for a couple of different sizes, so a linear search beats anything fancier
+	FreeList &getFreeList(size_t size)
+	{
+		for (FreeList &freeList : freeLists)
+		{
+			if (freeList.size == size)
+				return freeList;
+		}
+		freeLists.push_back(FreeList{ size, nullptr });
+		return freeLists.back();
+	}
+
+	std::vector<FreeList> freeLists;
+
+	std::vector<char*> chunks;
+	size_t currentChunk;
+	char *chunkPosition;
+	char *chunkEnd;
+};
+
+//a standard allocator that takes single objects from a MemoryPool, which is what node based containers like std::unordered_map ask for
+//arrays, like a hash table's buckets, still come from the normal heap
+template<class T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	template<class U>
+	struct rebind
+	{
+		typedef PoolAllocator<U> other;
+	};
+
+	explicit PoolAllocator(MemoryPool *pool)
+		:pool(pool)
+	{}
+
+	template<class U>
+	PoolAllocator(const PoolAllocator<U> &other)
+		:pool(other.pool)
+	{}
+
+	T *allocate(size_t n)
+	{
+		if (n == 1)
+			return static_cast<T*>(pool->allocate(sizeof(T)));
+		else
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, size_t n)
+	{
+		if (n == 1)
+			pool->deallocate(p, sizeof(T));
+		else
+			::operator delete(p);
+	}
+
+	template<class U>
+	bool operator==(const PoolAllocator<U> &other) const
+	{
+		return pool == other.pool;
+	}
+
+	template<class U>
+	bool operator!=(const PoolAllocator<U> &other) const
+	{
+		return pool != other.pool;
+	}
+
+private:
+	template<class U>
+	friend class PoolAllocator;
+
+	MemoryPool *pool;
+};
+
+#endif // POOLALLOCATOR_H
@@ -0,0 +1,644 @@
+#ifndef SPSCCHANNEL_H
+#define SPSCCHANNEL_H
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <limits>
+#include <utility>
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "utils/channel.h"
+
+//a channel for exactly one producer thread and one consumer thread, with the same interface as Channel
+//items are stored in a fixed size ring buffer, and pushes and pops don't take any locks unless the ring is full or empty
+//the producer and consumer only fall back to sleeping on a condition variable when they can't make progress
+template<class T>
+class SpscChannel
+{
+public:
+	enum FullPushBehavior { BLOCK, DROP_NEWEST, DROP_OLDEST };
+
+	//the capacity is rounded up to the next power of two
+	explicit SpscChannel(FullPushBehavior fullPushBehavior = BLOCK, size_t capacity = 1024);
+	SpscChannel(const SpscChannel &other) = delete;
+
+	//closing the front of the channel will cause all pushes into the channel to return false, permenently
+	//use it when a consumer wants to inform producers that nothing else will be consumed from the channel
+	bool isFrontClosed(void) const;
+	void closeFront(void);
+
+	//closing the back of the channel will cause all pops from the channel to return false, permenently
+	//use it when a producer wants to inform consumers that nothing else will be produced into the channel
+	bool isBackClosed(void) const;
+	void closeBack(void);
+
+	//put an item in the channel. returns false if the front of the channel was closed. only call this from the producer thread
+	bool push(const T& item);
+	bool push(T&& item);
+
+	//construct an item and put it in the channel. returns false if the front of the channel was closed
+	template<class... Args>
+	bool emplace(Args&&... args);
+
+	//put every item in the range into the channel, waking the consumer once for the whole range instead of once per item
+	//pass move iterators to move the items in. returns false if the front of the channel was closed
+	template<class InputIterator>
+	bool pushMany(InputIterator first, InputIterator last);
+
+	//get an item from the channel and place it in 'result'. if the channel is empty, block until something is added or until the back is closed
+	//returns false when because the channel is empty and the back is closed. only call this from the consumer thread
+	bool pop(T& result);
+
+	//move up to maxItems items from the channel onto the end of 'results'. if the channel is empty, block like pop()
+	//returns the number of items added, which is only 0 when the channel is empty and the back is closed
+	size_t popMany(std::vector<T>& results, size_t maxItems);
+
+	//same as popMany, but takes everything that's in the channel
+	size_t popAll(std::vector<T>& results);
+
+	//move everything that's currently in the channel onto the end of 'results' without blocking. returns the number of items added
+	size_t tryPopAll(std::vector<T>& results);
+
+	//notify the given signal whenever items are added or the back is closed, so one consumer can wait on several channels at once
+	//set it before anything is pushed into the channel
+	void setSignal(std::shared_ptr<ChannelSignal> signal);
+
+	//the number of items in the channel, which may already be out of date by the time it returns. safe to call from any thread
+	size_t getSize(void) const;
+	size_t getCapacity(void) const;
+
+	//the total time a BLOCK producer has spent waiting for room in the ring. safe to call from any thread
+	std::chrono::nanoseconds getBlockedTime(void) const;
+
+	//start counting pushes, pops, drops and waits. call it before anything is pushed into the channel
+	void enableMetrics(void);
+
+	//a copy of the counts so far, which is all zeros unless enableMetrics was called. safe to call from any thread
+	ChannelMetrics::Snapshot getMetrics(void) const;
+
+private:
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	//how many times to yield to the other side before going to sleep on a condition variable
+	static const int SPIN_COUNT = 16;
+
+	//each slot's sequence number tells whose turn it is. the slot is free for the push at position p when the sequence is p,
+	//and it holds the item for the pop at position p when the sequence is p + 1
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		T item;
+	};
+
+	//keep the producer's and the consumer's counters on separate cache lines so they don't bounce between cores
+	//each counter takes a whole line's worth of the object, so the members after it are a line away too
+	struct alignas(CACHE_LINE_SIZE) PaddedCounter
+	{
+		std::atomic<size_t> value;
+	};
+
+	static size_t roundUpToPowerOfTwo(size_t value);
+
+	template<class U>
+	bool pushItem(U&& item);
+
+	template<class U>
+	bool tryPush(U&& item);
+	bool tryPop(T& result);
+
+	//take the item at the given position out of the ring, if it's there and nobody else has taken it yet
+	bool tryClaim(size_t position, T& result);
+
+	bool isEmpty(void) const;
+	bool isFull(void) const;
+
+	//wake the other side up if it went to sleep waiting on us
+	void wakeConsumer(void);
+	void wakeProducer(void);
+
+	void addBlockedTime(std::chrono::steady_clock::time_point blockStart);
+
+	//the consumer only starts the clock once it has found the ring empty, which is the spin after the first
+	void addConsumerWait(int spin, std::chrono::steady_clock::time_point waitStart);
+
+	const FullPushBehavior fullPushBehavior;
+	const size_t capacity;
+	const size_t indexMask;
+	std::unique_ptr<Slot[]> ring;
+
+	//before C++17, new only aligns the channel to 16 bytes, so the members both sides read are kept a whole line away from the counters
+	char headPadding[CACHE_LINE_SIZE];
+
+	//the next position to pop from. the consumer advances it, and so does the producer when it drops the oldest item,
+	//so it's claimed with a compare and swap. the tail is only ever touched by the producer
+	PaddedCounter head;
+	PaddedCounter tail;
+
+	std::atomic<bool> _isFrontClosed;
+	std::atomic<bool> _isBackClosed;
+
+	//only used when one side has to sleep
+	std::atomic<bool> consumerWaiting;
+	std::atomic<bool> producerWaiting;
+	std::mutex waitMutex;
+	std::condition_variable fullWait;
+	std::condition_variable emptyWait;
+
+	//only updated on the slow path, once the producer has found the ring full
+	std::atomic<long long> blockedNanoseconds;
+
+	std::shared_ptr<ChannelSignal> signal;
+
+	//null unless metrics are enabled, so a channel without them only pays for the null checks
+	std::unique_ptr<ChannelMetrics> metrics;
+};
+
+template<class T>
+SpscChannel<T>::SpscChannel(FullPushBehavior fullPushBehavior, size_t capacity)
+	:fullPushBehavior(fullPushBehavior), capacity(roundUpToPowerOfTwo(capacity)), indexMask(this->capacity - 1),
+	ring(new Slot[this->capacity]), _isFrontClosed(false), _isBackClosed(false), consumerWaiting(false), producerWaiting(false), blockedNanoseconds(0)
+{
+	assert(capacity > 0);
+
+	for (size_t i = 0; i < this->capacity; i++)
+	{
+		ring[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	head.value.store(0, std::memory_order_relaxed);
+	tail.value.store(0, std::memory_order_relaxed);
+}
+
+template<class T>
+bool SpscChannel<T>::isFrontClosed(void) const
+{
+	return _isFrontClosed.load(std::memory_order_acquire);
+}
+
+template<class T>
+void SpscChannel<T>::closeFront(void)
+{
+	std::unique_lock<std::mutex> locker(waitMutex);
+
+	_isFrontClosed.store(true, std::memory_order_release);
+
+	//if the producer is waiting for the "full" condition variable, wake it up so that it knows it should stop pushing data
+	fullWait.notify_all();
+}
+
+template<class T>
+bool SpscChannel<T>::isBackClosed(void) const
+{
+	return _isBackClosed.load(std::memory_order_acquire);
+}
+
+template<class T>
+void SpscChannel<T>::closeBack(void)
+{
+	std::unique_lock<std::mutex> locker(waitMutex);
+
+	_isBackClosed.store(true, std::memory_order_release);
+
+	//if the consumer is waiting for the "empty" condition variable, wake it up so that it knows it's not going to get any more data
+	emptyWait.notify_all();
+
+	if (signal != nullptr)
+	{
+		signal->notify();
+	}
+}
+
+template<class T>
+bool SpscChannel<T>::push(const T& item)
+{
+	return pushItem(item);
+}
+
+template<class T>
+bool SpscChannel<T>::push(T&& item)
+{
+	return pushItem(std::move(item));
+}
+
+template<class T>
+template<class... Args>
+bool SpscChannel<T>::emplace(Args&&... args)
+{
+	//every slot in the ring already holds a constructed item, so build this one outside and move it in
+	return pushItem(T(std::forward<Args>(args)...));
+}
+
+template<class T>
+template<class InputIterator>
+bool SpscChannel<T>::pushMany(InputIterator first, InputIterator last)
+{
+	if (isBackClosed())
+	{
+		throw ChannelClosedException();
+	}
+
+	if (isFrontClosed())
+	{
+		return false;
+	}
+
+	//fast path: fill as much of the ring as we can, then wake the consumer once
+	for (; first != last && tryPush(*first); ++first)
+	{
+	}
+	wakeConsumer();
+
+	//the ring filled up, so the rest go through the full push behavior one at a time
+	for (; first != last; ++first)
+	{
+		if (!pushItem(*first))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class T>
+template<class U>
+bool SpscChannel<T>::pushItem(U&& item)
+{
+	if (isBackClosed())
+	{
+		throw ChannelClosedException();
+	}
+
+	if (isFrontClosed())
+	{
+		return false;
+	}
+
+	//fast path: there's room in the ring
+	if (tryPush(std::forward<U>(item)))
+	{
+		wakeConsumer();
+		return true;
+	}
+
+	if (fullPushBehavior == DROP_NEWEST)
+	{
+		//the ring is full, so we're just going to drop the given item
+		if (metrics != nullptr)
+		{
+			metrics->addDrops(1);
+		}
+		return true;
+	}
+	else if (fullPushBehavior == DROP_OLDEST)
+	{
+		//the slot we need holds the oldest item in the ring, so claim it away from the consumer and throw it out
+		//if the consumer is in the middle of reading that slot, neither the push nor the drop can go through until it's done
+		T dropped;
+		while (!tryPush(std::forward<U>(item)))
+		{
+			if (!tryClaim(tail.value.load(std::memory_order_relaxed) - capacity, dropped))
+			{
+				std::this_thread::yield();
+			}
+			else if (metrics != nullptr)
+			{
+				metrics->addDrops(1);
+			}
+		}
+		wakeConsumer();
+		return true;
+	}
+
+	//BLOCK: give the consumer a moment to make room, then sleep until it does or until it closes the front
+	auto blockStart = std::chrono::steady_clock::now();
+	for (int spin = 0; ; spin++)
+	{
+		if (spin < SPIN_COUNT)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			TRACE_SCOPE("SpscChannel push wait");
+			std::unique_lock<std::mutex> locker(waitMutex);
+			while (!isFrontClosed() && isFull())
+			{
+				//the consumer clears this flag when it wakes us, so set it again every time we go back to sleep
+				producerWaiting.store(true, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (isFrontClosed() || !isFull())
+				{
+					break;
+				}
+				fullWait.wait(locker);
+			}
+		}
+
+		if (isFrontClosed())
+		{
+			addBlockedTime(blockStart);
+			return false;
+		}
+
+		if (tryPush(std::forward<U>(item)))
+		{
+			addBlockedTime(blockStart);
+			wakeConsumer();
+			return true;
+		}
+	}
+}
+
+template<class T>
+bool SpscChannel<T>::pop(T& result)
+{
+	std::chrono::steady_clock::time_point waitStart;
+	for (int spin = 0; ; spin++)
+	{
+		//fast path: there's something in the ring
+		if (tryPop(result))
+		{
+			addConsumerWait(spin, waitStart);
+			wakeProducer();
+			return true;
+		}
+
+		//the producer closes the back after its last push, so once we see it closed, one more look tells us whether anything is left
+		if (isBackClosed())
+		{
+			bool popped = tryPop(result);
+			addConsumerWait(spin, waitStart);
+
+			if (popped)
+			{
+				wakeProducer();
+			}
+			return popped;
+		}
+
+		//the ring is empty. give the producer a moment, then block!
+		if (spin == 0 && metrics != nullptr)
+		{
+			waitStart = std::chrono::steady_clock::now();
+		}
+		if (spin < SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		TRACE_SCOPE("SpscChannel pop wait");
+		std::unique_lock<std::mutex> locker(waitMutex);
+		while (!isBackClosed() && isEmpty())
+		{
+			//the producer clears this flag when it wakes us, so set it again every time we go back to sleep
+			consumerWaiting.store(true, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (isBackClosed() || !isEmpty())
+			{
+				break;
+			}
+			emptyWait.wait(locker);
+		}
+	}
+}
+
+template<class T>
+size_t SpscChannel<T>::popMany(std::vector<T>& results, size_t maxItems)
+{
+	//block for the first item like a normal pop, then take whatever else is already there
+	T item;
+	if (maxItems == 0 || !pop(item))
+	{
+		return 0;
+	}
+	results.push_back(std::move(item));
+
+	size_t count = 1;
+	for (; count < maxItems && tryPop(item); count++)
+	{
+		results.push_back(std::move(item));
+	}
+
+	wakeProducer();
+	return count;
+}
+
+template<class T>
+size_t SpscChannel<T>::popAll(std::vector<T>& results)
+{
+	return popMany(results, std::numeric_limits<size_t>::max());
+}
+
+template<class T>
+size_t SpscChannel<T>::tryPopAll(std::vector<T>& results)
+{
+	T item;
+	size_t count = 0;
+	for (; tryPop(item); count++)
+	{
+		results.push_back(std::move(item));
+	}
+
+	if (count > 0)
+	{
+		wakeProducer();
+	}
+	return count;
+}
+
+template<class T>
+size_t SpscChannel<T>::roundUpToPowerOfTwo(size_t value)
+{
+	size_t result = 1;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+template<class T>
+template<class U>
+bool SpscChannel<T>::tryPush(U&& item)
+{
+	size_t position = tail.value.load(std::memory_order_relaxed);
+	Slot &slot = ring[position & indexMask];
+
+	//if the consumer hasn't released this slot since the last time around the ring, we're full
+	if (slot.sequence.load(std::memory_order_acquire) != position)
+	{
+		return false;
+	}
+
+	slot.item = std::forward<U>(item);
+	slot.sequence.store(position + 1, std::memory_order_release);
+	tail.value.store(position + 1, std::memory_order_relaxed);
+
+	if (metrics != nullptr)
+	{
+		metrics->addPushes(1);
+		metrics->recordDepth(getSize());
+	}
+	return true;
+}
+
+template<class T>
+bool SpscChannel<T>::tryPop(T& result)
+{
+	for (;;)
+	{
+		size_t position = head.value.load(std::memory_order_relaxed);
+		size_t sequence = ring[position & indexMask].sequence.load(std::memory_order_acquire);
+
+		//the slot hasn't been filled yet, so the ring is empty
+		if (sequence == position)
+		{
+			return false;
+		}
+
+		if (tryClaim(position, result))
+		{
+			if (metrics != nullptr)
+			{
+				metrics->addPops(1);
+			}
+			return true;
+		}
+
+		//the producer dropped this item out from under us, so try again from the new head
+	}
+}
+
+template<class T>
+bool SpscChannel<T>::tryClaim(size_t position, T& result)
+{
+	Slot &slot = ring[position & indexMask];
+
+	if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+	{
+		return false;
+	}
+	if (!head.value.compare_exchange_strong(position, position + 1, std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	result = std::move(slot.item);
+
+	//hand the slot back to the producer for its next lap around the ring
+	slot.sequence.store(position + capacity, std::memory_order_release);
+	return true;
+}
+
+template<class T>
+bool SpscChannel<T>::isEmpty(void) const
+{
+	size_t position = head.value.load(std::memory_order_acquire);
+	return ring[position & indexMask].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+template<class T>
+bool SpscChannel<T>::isFull(void) const
+{
+	size_t position = tail.value.load(std::memory_order_acquire);
+	return ring[position & indexMask].sequence.load(std::memory_order_acquire) != position;
+}
+
+template<class T>
+void SpscChannel<T>::setSignal(std::shared_ptr<ChannelSignal> s)
+{
+	signal = s;
+}
+
+template<class T>
+size_t SpscChannel<T>::getSize(void) const
+{
+	//read the head first, so a pop between the two loads can only make the result too big, never wrap around
+	size_t headPosition = head.value.load(std::memory_order_acquire);
+	size_t tailPosition = tail.value.load(std::memory_order_acquire);
+	return tailPosition > headPosition ? tailPosition - headPosition : 0;
+}
+
+template<class T>
+size_t SpscChannel<T>::getCapacity(void) const
+{
+	return capacity;
+}
+
+template<class T>
+std::chrono::nanoseconds SpscChannel<T>::getBlockedTime(void) const
+{
+	return std::chrono::nanoseconds(blockedNanoseconds.load(std::memory_order_relaxed));
+}
+
+template<class T>
+void SpscChannel<T>::addBlockedTime(std::chrono::steady_clock::time_point blockStart)
+{
+	auto blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blockStart);
+	blockedNanoseconds.fetch_add(blocked.count(), std::memory_order_relaxed);
+
+	if (metrics != nullptr)
+	{
+		metrics->addProducerWait(blocked);
+	}
+}
+
+template<class T>
+void SpscChannel<T>::addConsumerWait(int spin, std::chrono::steady_clock::time_point waitStart)
+{
+	if (metrics != nullptr && spin > 0)
+	{
+		metrics->addConsumerWait(std::chrono::steady_clock::now() - waitStart);
+	}
+}
+
+template<class T>
+void SpscChannel<T>::enableMetrics(void)
+{
+	metrics.reset(new ChannelMetrics());
+}
+
+template<class T>
+ChannelMetrics::Snapshot SpscChannel<T>::getMetrics(void) const
+{
+	return metrics != nullptr ? metrics->getSnapshot() : ChannelMetrics::Snapshot();
+}
+
+template<class T>
+void SpscChannel<T>::wakeConsumer(void)
+{
+	if (signal != nullptr)
+	{
+		signal->notify();
+	}
+
+	//pairs with the fence in pop: either the consumer sees our item before it sleeps, or we see that it's sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (consumerWaiting.load(std::memory_order_relaxed) && consumerWaiting.exchange(false))
+	{
+		std::unique_lock<std::mutex> locker(waitMutex);
+		emptyWait.notify_one();
+	}
+}
+
+template<class T>
+void SpscChannel<T>::wakeProducer(void)
+{
+	//pairs with the fence in push: either the producer sees the free slot before it sleeps, or we see that it's sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (producerWaiting.load(std::memory_order_relaxed) && producerWaiting.exchange(false))
+	{
+		std::unique_lock<std::mutex> locker(waitMutex);
+		fullWait.notify_one();
+	}
+}
+
+#endif // SPSCCHANNEL_H
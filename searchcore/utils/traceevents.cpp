@@ -0,0 +1,207 @@
+#include "traceevents.h"
+
+#include <QFile>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+	struct Span
+	{
+		const char *name;
+		qint64 start;
+		qint64 end;
+	};
+
+	//each thread's spans are kept in fixed size chunks, so the buffer never moves while it's being read
+	const size_t CHUNK_SIZE = 4096;
+	const size_t MAX_CHUNKS = 4096;
+
+	//only the owning thread writes to a buffer. it publishes each span by bumping the count after writing it,
+	//so a flush can read every span below the count without a lock
+	struct ThreadBuffer
+	{
+		int threadId;
+		std::atomic<const char*> threadName;
+		std::atomic<size_t> count;
+		std::atomic<Span*> chunks[MAX_CHUNKS];
+
+		explicit ThreadBuffer(int threadId)
+			:threadId(threadId), threadName(nullptr), count(0)
+		{
+			for (size_t i = 0; i < MAX_CHUNKS; i++)
+			{
+				chunks[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~ThreadBuffer(void)
+		{
+			for (size_t i = 0; i < MAX_CHUNKS; i++)
+			{
+				delete[] chunks[i].load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	struct TraceState
+	{
+		std::atomic<bool> enabled;
+		QString fileName;
+		std::chrono::steady_clock::time_point epoch;
+
+		//only locked when a thread records its first span, and when flushing
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+		TraceState(void)
+			:enabled(false), epoch(std::chrono::steady_clock::now())
+		{}
+	};
+
+	TraceState &getState(void)
+	{
+		static TraceState state;
+		return state;
+	}
+
+	//the buffers outlive their threads, so a thread that has already exited still shows up in the trace
+	thread_local ThreadBuffer *threadBuffer = nullptr;
+
+	ThreadBuffer *getThreadBuffer(void)
+	{
+		if (threadBuffer == nullptr)
+		{
+			TraceState &state = getState();
+			std::lock_guard<std::mutex> locker(state.buffersMutex);
+
+			state.buffers.emplace_back(new ThreadBuffer(int(state.buffers.size()) + 1));
+			threadBuffer = state.buffers.back().get();
+		}
+		return threadBuffer;
+	}
+}
+
+bool TraceEvents::enable(const QString &fileName, QString &errorMessage)
+{
+#ifdef SEARCH_TRACING
+	TraceState &state = getState();
+	{
+		std::lock_guard<std::mutex> locker(state.buffersMutex);
+		state.fileName = fileName;
+	}
+	state.enabled.store(true, std::memory_order_release);
+
+	Q_UNUSED(errorMessage)
+	return true;
+#else
+	Q_UNUSED(fileName)
+	errorMessage = "This build doesn't include tracing. Rebuild with CONFIG+=tracing to record traces.";
+	return false;
+#endif
+}
+
+bool TraceEvents::enableFromEnvironment(void)
+{
+	QByteArray fileName = qgetenv("SEARCH_TRACE");
+	if (fileName.isEmpty())
+		return false;
+
+	QString errorMessage;
+	return enable(QString::fromLocal8Bit(fileName), errorMessage);
+}
+
+bool TraceEvents::isEnabled(void)
+{
+	return getState().enabled.load(std::memory_order_relaxed);
+}
+
+bool TraceEvents::flush(QString &errorMessage)
+{
+	TraceState &state = getState();
+	if (!isEnabled())
+		return true;
+
+	std::lock_guard<std::mutex> locker(state.buffersMutex);
+
+	QFile file(state.fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		errorMessage = QString("Couldn't open %1: %2").arg(state.fileName, file.errorString());
+		return false;
+	}
+
+	//the timestamps in the format are in microseconds
+	QByteArray json = "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const std::unique_ptr<ThreadBuffer> &buffer : state.buffers)
+	{
+		QByteArray threadId = QByteArray::number(buffer->threadId);
+
+		const char *threadName = buffer->threadName.load(std::memory_order_acquire);
+		if (threadName != nullptr)
+		{
+			json += first ? "" : ",\n";
+			json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + threadId + ",\"args\":{\"name\":\"" + threadName + "\"}}";
+			first = false;
+		}
+
+		size_t count = buffer->count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Span &span = buffer->chunks[i / CHUNK_SIZE].load(std::memory_order_acquire)[i % CHUNK_SIZE];
+
+			json += first ? "" : ",\n";
+			json += "{\"name\":\"";
+			json += span.name;
+			json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + threadId;
+			json += ",\"ts\":" + QByteArray::number(span.start / 1000.0, 'f', 3);
+			json += ",\"dur\":" + QByteArray::number((span.end - span.start) / 1000.0, 'f', 3) + "}";
+			first = false;
+		}
+	}
+	json += "\n]}\n";
+
+	if (file.write(json) != json.size())
+	{
+		errorMessage = QString("Couldn't write to %1: %2").arg(state.fileName, file.errorString());
+		return false;
+	}
+	return true;
+}
+
+void TraceEvents::setThreadName(const char *name)
+{
+	if (isEnabled())
+	{
+		getThreadBuffer()->threadName.store(name, std::memory_order_release);
+	}
+}
+
+void TraceEvents::record(const char *name, qint64 startNanoseconds, qint64 endNanoseconds)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	//once a thread has filled every chunk, the rest of its spans are dropped rather than growing without bound
+	size_t index = buffer->count.load(std::memory_order_relaxed);
+	if (index >= CHUNK_SIZE * MAX_CHUNKS)
+		return;
+
+	Span *chunk = buffer->chunks[index / CHUNK_SIZE].load(std::memory_order_relaxed);
+	if (chunk == nullptr)
+	{
+		chunk = new Span[CHUNK_SIZE];
+		buffer->chunks[index / CHUNK_SIZE].store(chunk, std::memory_order_release);
+	}
+
+	chunk[index % CHUNK_SIZE] = Span{ name, startNanoseconds, endNanoseconds };
+	buffer->count.store(index + 1, std::memory_order_release);
+}
+
+qint64 TraceEvents::now(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getState().epoch).count();
+}
@@ -0,0 +1,104 @@
+#ifndef TRACEEVENTS_H
+#define TRACEEVENTS_H
+
+#include <QString>
+
+//records timed spans from any thread, and writes them out in the chrome trace event format, which chrome://tracing and perfetto can open
+//each thread records into its own buffer without taking any locks. the buffers are only read when the trace is flushed
+//the TRACE_ macros below compile to nothing unless the project is built with CONFIG+=tracing, which defines SEARCH_TRACING
+class TraceEvents
+{
+public:
+	//start recording, to be written to the given file when flush is called
+	//returns false if tracing wasn't compiled in
+	static bool enable(const QString &fileName, QString &errorMessage);
+
+	//enable recording if the SEARCH_TRACE environment variable holds a file name. returns true if recording was enabled
+	static bool enableFromEnvironment(void);
+
+	static bool isEnabled(void);
+
+	//write every span recorded so far to the file passed to enable. call it once the threads being traced are idle
+	static bool flush(QString &errorMessage);
+
+	//the name shown for the calling thread in the trace viewer. the name must outlive the trace, so pass a literal
+	static void setThreadName(const char *name);
+
+	//record a span on the calling thread. the name must outlive the trace, so pass a literal
+	static void record(const char *name, qint64 startNanoseconds, qint64 endNanoseconds);
+
+	//the current time on the trace's clock
+	static qint64 now(void);
+
+private:
+	TraceEvents(void) {}
+};
+
+//records the time between its construction and destruction as one span
+class ScopedTrace
+{
+public:
+	explicit ScopedTrace(const char *name)
+		:name(TraceEvents::isEnabled() ? name : nullptr), start(this->name != nullptr ? TraceEvents::now() : 0)
+	{}
+
+	~ScopedTrace(void)
+	{
+		if (name != nullptr)
+			TraceEvents::record(name, start, TraceEvents::now());
+	}
+
+private:
+	const char *name;
+	qint64 start;
+};
+
+//records one span for every batchSize calls to tick, for loops whose iterations are too short to be traced one at a time
+class TraceBatch
+{
+public:
+	TraceBatch(const char *name, int batchSize)
+		:name(TraceEvents::isEnabled() ? name : nullptr), batchSize(batchSize), count(0), start(this->name != nullptr ? TraceEvents::now() : 0)
+	{}
+
+	~TraceBatch(void)
+	{
+		if (name != nullptr && count > 0)
+			TraceEvents::record(name, start, TraceEvents::now());
+	}
+
+	void tick(void)
+	{
+		if (name != nullptr && ++count == batchSize)
+		{
+			qint64 end = TraceEvents::now();
+			TraceEvents::record(name, start, end);
+
+			start = end;
+			count = 0;
+		}
+	}
+
+private:
+	const char *name;
+	int batchSize;
+	int count;
+	qint64 start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef SEARCH_TRACING
+#define TRACE_SCOPE(name) ScopedTrace TRACE_CONCAT(scopedTrace, __LINE__)(name)
+#define TRACE_BATCH(variable, name, batchSize) TraceBatch variable(name, batchSize)
+#define TRACE_BATCH_TICK(variable) variable.tick()
+#define TRACE_THREAD_NAME(name) TraceEvents::setThreadName(name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_BATCH(variable, name, batchSize)
+#define TRACE_BATCH_TICK(variable)
+#define TRACE_THREAD_NAME(name)
+#endif
+
+#endif // TRACEEVENTS_H